@@ -100,7 +100,6 @@ void Model::import_yin_volume()
     m_yin_volume.setDimTheta( dim_lat );
     m_yin_volume.setDimPhi( dim_lon );
     m_yin_volume.setVeclen( 1 );
-    m_yin_volume.calculateCoords();
     m_yin_volume.readValues( filename );
     m_yin_volume.updateMinMaxCoords();
     m_yin_volume.updateMinMaxValues();
@@ -117,7 +116,7 @@ void Model::import_yang_volume()
     m_yang_volume.setDimTheta( dim_lat );
     m_yang_volume.setDimPhi( dim_lon );
     m_yang_volume.setVeclen( 1 );
-    m_yang_volume.calculateCoords();
+    m_yang_volume.shareGeometry( m_yin_volume );
     m_yang_volume.readValues( filename );
     m_yang_volume.updateMinMaxCoords();
     m_yang_volume.updateMinMaxValues();
@@ -132,7 +131,6 @@ void Model::import_zhong_volume()
     m_zhong_volume.setDimR( dim_rad );
     m_zhong_volume.setDim( dim_zhong );
     m_zhong_volume.setVeclen( 1 );
-    m_zhong_volume.calculateCoords();
     m_zhong_volume.readValues( filename );
     m_zhong_volume.updateMinMaxCoords();
     m_zhong_volume.updateMinMaxValues();
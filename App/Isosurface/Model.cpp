@@ -91,13 +91,35 @@ kvs::PolygonObject* Model::newFaces( const kvs::UnstructuredVolumeObject* volume
     return new kvs::ExternalFaces( volume );
 }
 
+/*===========================================================================*/
+/**
+ *  @brief  Returns the isovalues extracted in a single traversal of each volume.
+ *  @return isovalues derived from the current isovalue
+ */
+/*===========================================================================*/
+std::vector<double> Model::isovalues() const
+{
+    std::vector<double> isovalues( 1, m_isovalue );
+#if defined( JSST2019_TEST )
+    const float min_value = m_yin_volume.minValue();
+    const float max_value = m_yin_volume.maxValue();
+    isovalues.push_back( kvs::Math::Mix( min_value, max_value, 0.6f ) );
+    isovalues.push_back( kvs::Math::Mix( min_value, max_value, 0.4f ) );
+#endif
+    return isovalues;
+}
+
 kvs::PolygonObject* Model::newYinIsosurfaces() const
 {
-    const double isovalue = m_isovalue;
+    return this->newYinIsosurfaces( std::vector<double>( 1, m_isovalue ) );
+}
+
+kvs::PolygonObject* Model::newYinIsosurfaces( const std::vector<double>& isovalues ) const
+{
     const kvs::PolygonObject::NormalType n = kvs::PolygonObject::PolygonNormal;
     const bool d = true;
     const kvs::TransferFunction& tfunc = m_input.tfunc;
-    return new YYZVis::Isosurface( &m_yin_volume, isovalue, n, d, tfunc );
+    return new YYZVis::Isosurface( &m_yin_volume, isovalues, n, d, tfunc );
 
 //    ::VolumePointer volume( YinVolume::ToUnstructuredVolumeObject( &m_yin_volume ) );
 //    return this->newIsosurfaces( volume.get() );
@@ -105,11 +127,15 @@ kvs::PolygonObject* Model::newYinIsosurfaces() const
 
 kvs::PolygonObject* Model::newYangIsosurfaces() const
 {
-    const double isovalue = m_isovalue;
+    return this->newYangIsosurfaces( std::vector<double>( 1, m_isovalue ) );
+}
+
+kvs::PolygonObject* Model::newYangIsosurfaces( const std::vector<double>& isovalues ) const
+{
     const kvs::PolygonObject::NormalType n = kvs::PolygonObject::PolygonNormal;
     const bool d = true;
     const kvs::TransferFunction& tfunc = m_input.tfunc;
-    return new YYZVis::Isosurface( &m_yang_volume, isovalue, n, d, tfunc );
+    return new YYZVis::Isosurface( &m_yang_volume, isovalues, n, d, tfunc );
 
 //    ::VolumePointer volume( YangVolume::ToUnstructuredVolumeObject( &m_yang_volume ) );
 //    return this->newIsosurfaces( volume.get() );
@@ -117,11 +143,15 @@ kvs::PolygonObject* Model::newYangIsosurfaces() const
 
 kvs::PolygonObject* Model::newZhongIsosurfaces() const
 {
-    const double isovalue = m_isovalue;
+    return this->newZhongIsosurfaces( std::vector<double>( 1, m_isovalue ) );
+}
+
+kvs::PolygonObject* Model::newZhongIsosurfaces( const std::vector<double>& isovalues ) const
+{
     const kvs::PolygonObject::NormalType n = kvs::PolygonObject::PolygonNormal;
     const bool d = true;
     const kvs::TransferFunction& tfunc = m_input.tfunc;
-    return new YYZVis::Isosurface( &m_zhong_volume, isovalue, n, d, tfunc );
+    return new YYZVis::Isosurface( &m_zhong_volume, isovalues, n, d, tfunc );
 
 //    ::VolumePointer volume( ZhongVolume::ToUnstructuredVolumeObject( &m_zhong_volume ) );
 //    return this->newIsosurfaces( volume.get() );
@@ -156,10 +186,11 @@ void Model::import_yin_volume()
     m_yin_volume.setDimTheta( dim_lat );
     m_yin_volume.setDimPhi( dim_lon );
     m_yin_volume.setVeclen( 1 );
-    m_yin_volume.calculateCoords();
     m_yin_volume.readValues( filename );
     m_yin_volume.updateMinMaxCoords();
     m_yin_volume.updateMinMaxValues();
+    m_yin_volume.updateBrickMinMax();
+    m_yin_volume.updateSpanSpaceIndex();
 }
 
 void Model::import_yang_volume()
@@ -173,10 +204,12 @@ void Model::import_yang_volume()
     m_yang_volume.setDimTheta( dim_lat );
     m_yang_volume.setDimPhi( dim_lon );
     m_yang_volume.setVeclen( 1 );
-    m_yang_volume.calculateCoords();
+    m_yang_volume.shareGeometry( m_yin_volume );
     m_yang_volume.readValues( filename );
     m_yang_volume.updateMinMaxCoords();
     m_yang_volume.updateMinMaxValues();
+    m_yang_volume.updateBrickMinMax();
+    m_yang_volume.updateSpanSpaceIndex();
 }
 
 void Model::import_zhong_volume()
@@ -188,10 +221,11 @@ void Model::import_zhong_volume()
     m_zhong_volume.setDimR( dim_rad );
     m_zhong_volume.setDim( dim_zhong );
     m_zhong_volume.setVeclen( 1 );
-    m_zhong_volume.calculateCoords();
     m_zhong_volume.readValues( filename );
     m_zhong_volume.updateMinMaxCoords();
     m_zhong_volume.updateMinMaxValues();
+    m_zhong_volume.updateBrickMinMax();
+    m_zhong_volume.updateSpanSpaceIndex();
 }
 
 void Model::update_min_max_values()
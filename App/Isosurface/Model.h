@@ -7,6 +7,7 @@
 #include <kvs/PolygonObject>
 #include <kvs/UnstructuredVolumeObject>
 #include <kvs/TransferFunction>
+#include <vector>
 
 
 namespace local
@@ -41,6 +42,7 @@ public:
 
     float isovalue() const { return m_isovalue; }
     void setIsovalue( const float value ) { m_isovalue = value; }
+    std::vector<double> isovalues() const;
 
     YinVolume* newYinVolume() const { return new YinVolume( m_yin_volume ); }
     YangVolume* newYangVolume() const { return new YangVolume( m_yang_volume ); }
@@ -61,6 +63,9 @@ public:
     kvs::PolygonObject* newYinIsosurfaces() const;
     kvs::PolygonObject* newYangIsosurfaces() const;
     kvs::PolygonObject* newZhongIsosurfaces() const;
+    kvs::PolygonObject* newYinIsosurfaces( const std::vector<double>& isovalues ) const;
+    kvs::PolygonObject* newYangIsosurfaces( const std::vector<double>& isovalues ) const;
+    kvs::PolygonObject* newZhongIsosurfaces( const std::vector<double>& isovalues ) const;
     kvs::PolygonObject* newIsosurfaces( const kvs::UnstructuredVolumeObject* volume ) const;
 
 private:
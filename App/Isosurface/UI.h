@@ -8,6 +8,7 @@
 #include <kvs/Font>
 #include <kvs/FontMetrics>
 #include <string>
+#include <vector>
 
 
 namespace local
@@ -39,35 +40,6 @@ public:
         {
             if ( state() ) { m_view->screen().scene()->object( m_name )->show(); }
             else { m_view->screen().scene()->object( m_name )->hide(); }
-
-#if defined( JSST2019_TEST )
-            if ( m_name == "YinIso" )
-            {
-                if ( state() ) { m_view->screen().scene()->object( "YinIso2" )->show(); }
-                else { m_view->screen().scene()->object( "YinIso2" )->hide(); }
-
-                if ( state() ) { m_view->screen().scene()->object( "YinIso3" )->show(); }
-                else { m_view->screen().scene()->object( "YinIso3" )->hide(); }
-            }
-
-            if ( m_name == "YangIso" )
-            {
-                if ( state() ) { m_view->screen().scene()->object( "YangIso2" )->show(); }
-                else { m_view->screen().scene()->object( "YangIso2" )->hide(); }
-
-                if ( state() ) { m_view->screen().scene()->object( "YangIso3" )->show(); }
-                else { m_view->screen().scene()->object( "YangIso3" )->hide(); }
-            }
-
-            if ( m_name == "ZhongIso" )
-            {
-                if ( state() ) { m_view->screen().scene()->object( "ZhongIso2" )->show(); }
-                else { m_view->screen().scene()->object( "ZhongIso2" )->hide(); }
-
-                if ( state() ) { m_view->screen().scene()->object( "ZhongIso3" )->show(); }
-                else { m_view->screen().scene()->object( "ZhongIso3" )->hide(); }
-            }
-#endif
         }
     }
 };
@@ -189,24 +161,25 @@ public:
     void sliderReleased()
     {
         m_model->setIsovalue( this->value() );
+        const std::vector<double> isovalues = m_model->isovalues();
 
         // Yin
         {
-            kvs::PolygonObject* object = m_model->newYinIsosurfaces();
+            kvs::PolygonObject* object = m_model->newYinIsosurfaces( isovalues );
             object->setName( "YinIso" );
             m_view->screen().scene()->replaceObject( "YinIso", object );
         }
 
         // Yang
         {
-            kvs::PolygonObject* object = m_model->newYangIsosurfaces();
+            kvs::PolygonObject* object = m_model->newYangIsosurfaces( isovalues );
             object->setName( "YangIso" );
             m_view->screen().scene()->replaceObject( "YangIso", object );
         }
 
         // Zhong
         {
-            kvs::PolygonObject* object = m_model->newZhongIsosurfaces();
+            kvs::PolygonObject* object = m_model->newZhongIsosurfaces( isovalues );
             object->setName( "ZhongIso" );
             m_view->screen().scene()->replaceObject( "ZhongIso", object );
         }
@@ -3,6 +3,7 @@
 #include <kvs/PolygonRenderer>
 #include <kvs/Light>
 #include <kvs/Math>
+#include <vector>
 
 #if defined( JSST2019_TEST )
 #include <kvs/PaintEventListener>
@@ -27,12 +28,6 @@ class FPSTimer : public kvs::PaintEventListener
             elapse_time += scene()->renderer("YinIso")->timer().sec();
             elapse_time += scene()->renderer("YangIso")->timer().sec();
             elapse_time += scene()->renderer("ZhongIso")->timer().sec();
-            elapse_time += scene()->renderer("YinIso2")->timer().sec();
-            elapse_time += scene()->renderer("YangIso2")->timer().sec();
-            elapse_time += scene()->renderer("ZhongIso2")->timer().sec();
-            elapse_time += scene()->renderer("YinIso3")->timer().sec();
-            elapse_time += scene()->renderer("YangIso3")->timer().sec();
-            elapse_time += scene()->renderer("ZhongIso3")->timer().sec();
             counter++;
         }
     }
@@ -72,12 +67,6 @@ void View::setup()
     m_screen.scene()->object("YinIso")->multiplyXform( x );
     m_screen.scene()->object("YangIso")->multiplyXform( x );
     m_screen.scene()->object("ZhongIso")->multiplyXform( x );
-    m_screen.scene()->object("YinIso2")->multiplyXform( x );
-    m_screen.scene()->object("YangIso2")->multiplyXform( x );
-    m_screen.scene()->object("ZhongIso2")->multiplyXform( x );
-    m_screen.scene()->object("YinIso3")->multiplyXform( x );
-    m_screen.scene()->object("YangIso3")->multiplyXform( x );
-    m_screen.scene()->object("ZhongIso3")->multiplyXform( x );
     m_screen.addEvent( new FPSTimer );
 #endif
 }
@@ -168,9 +157,13 @@ void View::setup_isosurfaces()
 
     std::cout << "SETUP ISOSURFACES ..." << std::endl;
 
+    // The isosurfaces at all of the isovalues are extracted in a single
+    // traversal of each volume.
+    const std::vector<double> isovalues = m_model->isovalues();
+
     // Yin
     {
-        kvs::PolygonObject* object = m_model->newYinIsosurfaces();
+        kvs::PolygonObject* object = m_model->newYinIsosurfaces( isovalues );
         object->setName( "YinIso" );
         object->print( std::cout << "YIN ISOSURFACE DATA" << std::endl, indent );
 
@@ -182,7 +175,7 @@ void View::setup_isosurfaces()
 
     // Yang
     {
-        kvs::PolygonObject* object = m_model->newYangIsosurfaces();
+        kvs::PolygonObject* object = m_model->newYangIsosurfaces( isovalues );
         object->setName( "YangIso" );
         object->print( std::cout << "YANG ISOSURFACE DATA" << std::endl, indent );
 
@@ -194,7 +187,7 @@ void View::setup_isosurfaces()
 
     // Zhong
     {
-        kvs::PolygonObject* object = m_model->newZhongIsosurfaces();
+        kvs::PolygonObject* object = m_model->newZhongIsosurfaces( isovalues );
         object->setName( "ZhongIso" );
         object->print( std::cout << "ZHONG ISOSURFACE DATA" << std::endl, indent );
 
@@ -203,87 +196,6 @@ void View::setup_isosurfaces()
         renderer->setEnabledShading( enable_shading );
         m_screen.registerObject( object, renderer );
     }
-
-#if JSST2019_TEST
-    const float min_value = m_model->constYinVolume().minValue();
-    const float max_value = m_model->constYinVolume().maxValue();
-    const float ratio2 = 0.6f;
-    const float ratio3 = 0.4f;
-
-    m_model->setIsovalue( kvs::Math::Mix( min_value, max_value, ratio2 ) );
-    // Yin
-    {
-        kvs::PolygonObject* object = m_model->newYinIsosurfaces();
-        object->setName( "YinIso2" );
-        object->print( std::cout << "YIN ISOSURFACE DATA" << std::endl, indent );
-
-        Renderer* renderer = new Renderer();
-        renderer->setName( "YinIso2" );
-        renderer->setEnabledShading( enable_shading );
-        m_screen.registerObject( object, renderer );
-    }
-
-    // Yang
-    {
-        kvs::PolygonObject* object = m_model->newYangIsosurfaces();
-        object->setName( "YangIso2" );
-        object->print( std::cout << "YANG ISOSURFACE DATA" << std::endl, indent );
-
-        Renderer* renderer = new Renderer();
-        renderer->setName( "YangIso2" );
-        renderer->setEnabledShading( enable_shading );
-        m_screen.registerObject( object, renderer );
-    }
-
-    // Zhong
-    {
-        kvs::PolygonObject* object = m_model->newZhongIsosurfaces();
-        object->setName( "ZhongIso2" );
-        object->print( std::cout << "ZHONG ISOSURFACE DATA" << std::endl, indent );
-
-        Renderer* renderer = new Renderer();
-        renderer->setName( "ZhongIso2" );
-        renderer->setEnabledShading( enable_shading );
-        m_screen.registerObject( object, renderer );
-    }
-
-    m_model->setIsovalue( kvs::Math::Mix( min_value, max_value, ratio3 ) );
-    // Yin
-    {
-        kvs::PolygonObject* object = m_model->newYinIsosurfaces();
-        object->setName( "YinIso3" );
-        object->print( std::cout << "YIN ISOSURFACE DATA" << std::endl, indent );
-
-        Renderer* renderer = new Renderer();
-        renderer->setName( "YinIso3" );
-        renderer->setEnabledShading( enable_shading );
-        m_screen.registerObject( object, renderer );
-    }
-
-    // Yang
-    {
-        kvs::PolygonObject* object = m_model->newYangIsosurfaces();
-        object->setName( "YangIso3" );
-        object->print( std::cout << "YANG ISOSURFACE DATA" << std::endl, indent );
-
-        Renderer* renderer = new Renderer();
-        renderer->setName( "YangIso3" );
-        renderer->setEnabledShading( enable_shading );
-        m_screen.registerObject( object, renderer );
-    }
-
-    // Zhong
-    {
-        kvs::PolygonObject* object = m_model->newZhongIsosurfaces();
-        object->setName( "ZhongIso3" );
-        object->print( std::cout << "ZHONG ISOSURFACE DATA" << std::endl, indent );
-
-        Renderer* renderer = new Renderer();
-        renderer->setName( "ZhongIso3" );
-        renderer->setEnabledShading( enable_shading );
-        m_screen.registerObject( object, renderer );
-    }
-#endif
 }
 
 } // end of namespace local
@@ -2,6 +2,7 @@
 #include <kvs/CommandLine>
 #include <kvs/TransferFunction>
 #include <kvs/DivergingColorMap>
+#include <kvs/Message>
 #include <string>
 
 
@@ -29,6 +30,7 @@ public:
     size_t dim_zhong; ///< dimension of the cubic zhong grid
     bool previous_method; ///< if true, previous PBR method will be used
     bool enable_shading; ///< if true, shading will be available in the PBR
+    std::string sampling; ///< particle sampling method (uniform, metropolis or rejection)
     kvs::TransferFunction tfunc; ///< transfer function
 
     Input( int argc, char** argv )
@@ -44,6 +46,7 @@ public:
         m_commandline.addOption( "repeat", "Number of repetitions for PBVR. (defulat: 1)", 1, false );
         m_commandline.addOption( "prev", "Use previous particle generation technique." );
         m_commandline.addOption( "shading", "Enable shading." );
+        m_commandline.addOption( "sampling", "Particle sampling method: uniform, metropolis or rejection. (default: uniform, a fast preview; use metropolis for the former default output)", 1, false );
         m_commandline.addHelpOption();
     }
 
@@ -64,6 +67,12 @@ public:
         repeats = m_commandline.hasOption("repeat") ? m_commandline.optionValue<size_t>("repeat") : 1;
         previous_method = m_commandline.hasOption("prev");
         enable_shading = m_commandline.hasOption("shading");
+        sampling = m_commandline.hasOption("sampling") ? m_commandline.optionValue<std::string>("sampling") : "uniform";
+        if ( sampling != "uniform" && sampling != "metropolis" && sampling != "rejection" )
+        {
+            kvsMessageError() << "Unknown sampling method: " << sampling << std::endl;
+            return false;
+        }
         tfunc = this->create_transfer_function(); // better to be set via a comman line option
 
         return true;
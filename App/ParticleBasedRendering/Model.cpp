@@ -12,6 +12,14 @@ namespace
 
 typedef kvs::SharedPointer<kvs::UnstructuredVolumeObject> VolumePointer;
 
+// The name has been validated in local::Input::parse.
+YYZVis::YinYangGridSampling::SamplingMethod SamplingMethod( const std::string& name )
+{
+    if ( name == "metropolis" ) { return YYZVis::YinYangGridSampling::Metropolis; }
+    if ( name == "rejection" ) { return YYZVis::YinYangGridSampling::Rejection; }
+    return YYZVis::YinYangGridSampling::Uniform;
+}
+
 }
 
 namespace local
@@ -107,29 +115,49 @@ kvs::PointObject* Model::newZhongParticles() const
 
 kvs::PointObject* Model::newYinParticles( const YinVolume* volume ) const
 {
+    // Independent particle sets for the repetitions are generated at once.
     const size_t repeats = m_input.repeats;
     const size_t subpixels = 1; // fixed to '1'
-    const size_t level = static_cast<size_t>( subpixels * std::sqrt( double( repeats ) ) );
     const float step = 0.1f;
-    return new YYZVis::YinYangGridSampling( volume, level, step, m_input.tfunc );
+    YYZVis::YinYangGridSampling* mapper = new YYZVis::YinYangGridSampling();
+    mapper->setTransferFunction( m_input.tfunc );
+    mapper->setSubpixelLevel( subpixels );
+    mapper->setSamplingStep( step );
+    mapper->setSamplingMethod( ::SamplingMethod( m_input.sampling ) );
+    mapper->setNumberOfEnsembles( repeats );
+    mapper->exec( volume );
+    return mapper;
 }
 
 kvs::PointObject* Model::newYangParticles( const YangVolume* volume ) const
 {
+    // Independent particle sets for the repetitions are generated at once.
     const size_t repeats = m_input.repeats;
     const size_t subpixels = 1; // fixed to '1'
-    const size_t level = static_cast<size_t>( subpixels * std::sqrt( double( repeats ) ) );
     const float step = 0.1f;
-    return new YYZVis::YinYangGridSampling( volume, level, step, m_input.tfunc );
+    YYZVis::YinYangGridSampling* mapper = new YYZVis::YinYangGridSampling();
+    mapper->setTransferFunction( m_input.tfunc );
+    mapper->setSubpixelLevel( subpixels );
+    mapper->setSamplingStep( step );
+    mapper->setSamplingMethod( ::SamplingMethod( m_input.sampling ) );
+    mapper->setNumberOfEnsembles( repeats );
+    mapper->exec( volume );
+    return mapper;
 }
 
 kvs::PointObject* Model::newZhongParticles( const ZhongVolume* volume ) const
 {
+    // Independent particle sets for the repetitions are generated at once.
     const size_t repeats = m_input.repeats;
     const size_t subpixels = 1; // fixed to '1'
-    const size_t level = static_cast<size_t>( subpixels * std::sqrt( double( repeats ) ) );
     const float step = 0.1f;
-    return new YYZVis::ZhongGridSampling( volume, level, step, m_input.tfunc );
+    YYZVis::ZhongGridSampling* mapper = new YYZVis::ZhongGridSampling();
+    mapper->setTransferFunction( m_input.tfunc );
+    mapper->setSubpixelLevel( subpixels );
+    mapper->setSamplingStep( step );
+    mapper->setNumberOfEnsembles( repeats );
+    mapper->exec( volume );
+    return mapper;
 }
 
 kvs::PointObject* Model::newParticles( const kvs::UnstructuredVolumeObject* volume ) const
@@ -152,10 +180,10 @@ void Model::import_yin_volume()
     m_yin_volume.setDimTheta( dim_lat );
     m_yin_volume.setDimPhi( dim_lon );
     m_yin_volume.setVeclen( 1 );
-    m_yin_volume.calculateCoords();
     m_yin_volume.readValues( filename );
     m_yin_volume.updateMinMaxCoords();
     m_yin_volume.updateMinMaxValues();
+    m_yin_volume.updateBrickMinMax();
 }
 
 void Model::import_yang_volume()
@@ -169,10 +197,11 @@ void Model::import_yang_volume()
     m_yang_volume.setDimTheta( dim_lat );
     m_yang_volume.setDimPhi( dim_lon );
     m_yang_volume.setVeclen( 1 );
-    m_yang_volume.calculateCoords();
+    m_yang_volume.shareGeometry( m_yin_volume );
     m_yang_volume.readValues( filename );
     m_yang_volume.updateMinMaxCoords();
     m_yang_volume.updateMinMaxValues();
+    m_yang_volume.updateBrickMinMax();
 }
 
 void Model::import_zhong_volume()
@@ -184,10 +213,10 @@ void Model::import_zhong_volume()
     m_zhong_volume.setDimR( dim_rad );
     m_zhong_volume.setDim( dim_zhong );
     m_zhong_volume.setVeclen( 1 );
-    m_zhong_volume.calculateCoords();
     m_zhong_volume.readValues( filename );
     m_zhong_volume.updateMinMaxCoords();
     m_zhong_volume.updateMinMaxValues();
+    m_zhong_volume.updateBrickMinMax();
 }
 
 void Model::update_min_max_values()
@@ -115,7 +115,7 @@ public:
         yin->print( std::cout << "YIN VOLUME DATA" << std::endl, kvs::Indent(2) );
 
         const std::string filename_yang = m_command.optionValue<std::string>("yang");
-        YinYangObject* yang = this->import_yang( filename_yang );
+        YinYangObject* yang = this->import_yang( filename_yang, yin );
         yang->setName("Yang");
         yang->print( std::cout << "YANG VOLUME DATA" << std::endl, kvs::Indent(2) );
 
@@ -227,14 +227,13 @@ private:
         volume->setDimTheta( dim_lat );
         volume->setDimPhi( dim_lon );
         volume->setVeclen( 1 );
-        volume->calculateCoords();
         volume->readValues( filename );
         volume->updateMinMaxCoords();
         volume->updateMinMaxValues();
         return volume;
     }
 
-    YinYangObject* import_yang( const std::string& filename )
+    YinYangObject* import_yang( const std::string& filename, const YinYangObject* yin )
     {
         const size_t dim_rad = m_command.optionValue<size_t>("dim_rad");
         const size_t dim_lat = m_command.optionValue<size_t>("dim_lat");
@@ -246,7 +245,7 @@ private:
         volume->setDimTheta( dim_lat );
         volume->setDimPhi( dim_lon );
         volume->setVeclen( 1 );
-        volume->calculateCoords();
+        volume->shareGeometry( *yin );
         volume->readValues( filename );
         volume->updateMinMaxCoords();
         volume->updateMinMaxValues();
@@ -262,7 +261,6 @@ private:
         volume->setDimR( dim_rad );
         volume->setDim( dim_zhong );
         volume->setVeclen( 1 );
-        volume->calculateCoords();
         volume->readValues( filename );
         volume->updateMinMaxCoords();
         volume->updateMinMaxValues();
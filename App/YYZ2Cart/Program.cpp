@@ -1,10 +1,6 @@
 #include "Program.h"
 #include "Input.h"
-#include <YYZVis/Lib/YinVolumeImporter.h>
-#include <YYZVis/Lib/YangVolumeImporter.h>
-#include <YYZVis/Lib/ZhongVolumeImporter.h>
-#include <YYZVis/Lib/UpdateMinMaxValues.h>
-#include <YYZVis/Lib/UpdateMinMaxCoords.h>
+#include <YYZVis/Lib/YinYangZhongImporter.h>
 #include <YYZVis/Lib/UniformGridMerger.h>
 #include <kvs/Indent>
 
@@ -20,11 +16,11 @@ int Program::exec( int argc, char** argv )
     // Import YYZ data.
     std::cout << "IMPORT VOLUMES ..." << std::endl;
     const std::string input_file( input.filename );
-    auto yin_volume = YYZVis::YinVolumeImporter( input_file );
-    auto yng_volume = YYZVis::YangVolumeImporter( input_file );
-    auto zng_volume = YYZVis::ZhongVolumeImporter( input_file );
-    YYZVis::UpdateMinMaxValues( &yin_volume, &yng_volume, &zng_volume );
-    YYZVis::UpdateMinMaxCoords( &yin_volume, &yng_volume, &zng_volume );
+    YYZVis::YinYangZhongImporter volumes( input_file );
+    if ( !volumes.isSuccess() ) { return 1; }
+    auto& yin_volume = volumes.yinVolume();
+    auto& yng_volume = volumes.yangVolume();
+    auto& zng_volume = volumes.zhongVolume();
 
     // Dump.
     const kvs::Indent indent( 4 );
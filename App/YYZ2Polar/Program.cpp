@@ -21,14 +21,13 @@ YYZVis::YinYangVolumeObject ImportYinVolume( const local::Input& input )
     object.setDimTheta( dim_lat );
     object.setDimPhi( dim_lon );
     object.setVeclen( 1 );
-    object.calculateCoords();
     object.readValues( filename );
     object.updateMinMaxCoords();
     object.updateMinMaxValues();
     return object;
 }
 
-YYZVis::YinYangVolumeObject ImportYangVolume( const local::Input& input )
+YYZVis::YinYangVolumeObject ImportYangVolume( const local::Input& input, const YYZVis::YinYangVolumeObject& yin_volume )
 {
     const size_t dim_rad = input.dim_rad;
     const size_t dim_lat = input.dim_lat;
@@ -41,7 +40,7 @@ YYZVis::YinYangVolumeObject ImportYangVolume( const local::Input& input )
     object.setDimTheta( dim_lat );
     object.setDimPhi( dim_lon );
     object.setVeclen( 1 );
-    object.calculateCoords();
+    object.shareGeometry( yin_volume );
     object.readValues( filename );
     object.updateMinMaxCoords();
     object.updateMinMaxValues();
@@ -58,7 +57,6 @@ YYZVis::ZhongVolumeObject ImportZhongVolume( const local::Input& input )
     object.setDimR( dim_rad );
     object.setDim( dim_zhong );
     object.setVeclen( 1 );
-    object.calculateCoords();
     object.readValues( filename );
     object.updateMinMaxCoords();
     object.updateMinMaxValues();
@@ -123,7 +121,7 @@ int Program::exec( int argc, char** argv )
 
     std::cout << "IMPORT VOLUMES ..." << std::endl;
     YYZVis::YinYangVolumeObject yin_volume = ::ImportYinVolume( input );
-    YYZVis::YinYangVolumeObject yang_volume = ::ImportYangVolume( input );
+    YYZVis::YinYangVolumeObject yang_volume = ::ImportYangVolume( input, yin_volume );
     YYZVis::ZhongVolumeObject zhong_volume = ::ImportZhongVolume( input );
     ::UpdateMinMaxValues( yin_volume, yang_volume, zhong_volume );
     ::UpdateMinMaxCoords( yin_volume, yang_volume, zhong_volume );
@@ -40,40 +40,9 @@ public:
         const YYZVis::YinYangVolumeObject& yin_volume,
         const YYZVis::YinYangVolumeObject& yang_volume,
         const YYZVis::ZhongVolumeObject& zhong_volume );
-    void iFind(
-        float rad, float tht, float phi,
-        int index,
-        const YYZVis::YinYangVolumeObject& yoy_object);
-    void iFind_zhong(
-        float x, float y, float z,
-        int index,
-        const YYZVis::ZhongVolumeObject& z_object );
     void sgrid__rtp2xyz (
         float rad, float tht, float phi,
         float cart[3] );
-    void sgrid__xyz2rtp(
-        float x, float y, float z,
-        float polar[3],
-        const YYZVis::YinYangVolumeObject& object);
-    void ogrid__find_near_corner(
-        float rad, float theta, float phi,
-        int index,
-        const YYZVis::YinYangVolumeObject& object );
-    int  igrid__find_nearleft(
-        char axis,
-        float c,
-        const YYZVis::ZhongVolumeObject& object );
-    void ogrid_to_sgrid_localize(
-        int i1, int j1, int k1,
-        float wr1, float wt1, float wp1,
-        float rad, float tht, float phi,
-        int index,
-        const YYZVis::YinYangVolumeObject& object );
-    void igrid_to_sgrid_localize(
-        int i1, int j1, int k1,
-        float wr1, float wt1, float wp1,
-        int index,
-        const YYZVis::ZhongVolumeObject& object );
   };
 }  // end of namespace local
 
@@ -0,0 +1,165 @@
+#include "BrickMinMax.h"
+#include "Parallel.h"
+#include "ValueType.h"
+#include <kvs/Math>
+#include <limits>
+
+
+namespace
+{
+
+template <typename ValueType>
+inline void CalculateMinMax(
+    const ValueType* values,
+    const kvs::Vec3ui& resolution,
+    const size_t brick_size,
+    const kvs::Vec3ui& nbricks,
+    kvs::Real32* min_values,
+    kvs::Real32* max_values )
+{
+    const size_t dim0 = resolution[0];
+    const size_t dim1 = resolution[0] * resolution[1];
+    YYZVis::Parallel::For( 0, nbricks[2], [&]( const size_t bk )
+    {
+        const size_t k0 = bk * brick_size;
+        const size_t k1 = kvs::Math::Min( k0 + brick_size, size_t( resolution[2] - 1 ) );
+        for ( size_t bj = 0; bj < nbricks[1]; bj++ )
+        {
+            const size_t j0 = bj * brick_size;
+            const size_t j1 = kvs::Math::Min( j0 + brick_size, size_t( resolution[1] - 1 ) );
+            for ( size_t bi = 0; bi < nbricks[0]; bi++ )
+            {
+                const size_t i0 = bi * brick_size;
+                const size_t i1 = kvs::Math::Min( i0 + brick_size, size_t( resolution[0] - 1 ) );
+
+                // The nodes [i0,i1] x [j0,j1] x [k0,k1] of the cells in the brick.
+                ValueType min_value = values[ i0 + dim0 * j0 + dim1 * k0 ];
+                ValueType max_value = min_value;
+                for ( size_t k = k0; k <= k1; k++ )
+                {
+                    for ( size_t j = j0; j <= j1; j++ )
+                    {
+                        const ValueType* pvalues = values + dim0 * j + dim1 * k;
+                        for ( size_t i = i0; i <= i1; i++ )
+                        {
+                            min_value = kvs::Math::Min( min_value, pvalues[i] );
+                            max_value = kvs::Math::Max( max_value, pvalues[i] );
+                        }
+                    }
+                }
+
+                const size_t index = bi + nbricks[0] * ( bj + nbricks[1] * bk );
+                min_values[index] = YYZVis::RoundToReal32( min_value, -std::numeric_limits<kvs::Real32>::infinity() );
+                max_values[index] = YYZVis::RoundToReal32( max_value, std::numeric_limits<kvs::Real32>::infinity() );
+            }
+        }
+    } );
+}
+
+struct MinMaxCalculator
+{
+    kvs::Vec3ui resolution; ///< number of nodes along each axis
+    size_t brick_size; ///< number of cells along each axis of a brick
+    kvs::Vec3ui nbricks; ///< number of bricks along each axis
+    kvs::Real32* min_values; ///< min. values of the bricks
+    kvs::Real32* max_values; ///< max. values of the bricks
+
+    template <typename ValueType>
+    void operator ()( const ValueType* values ) const
+    {
+        ::CalculateMinMax( values, resolution, brick_size, nbricks, min_values, max_values );
+    }
+};
+
+} // end of namespace
+
+
+namespace YYZVis
+{
+
+BrickMinMax::BrickMinMax():
+    m_brick_size( DefaultBrickSize ),
+    m_dims( 0, 0, 0 ),
+    m_nbricks( 0, 0, 0 ),
+    m_values_data( NULL ),
+    m_nvalues( 0 ),
+    m_values_type( kvs::Type::UnknownType )
+{
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Checks whether the min/max values are created for the node values.
+ *  @param  values [in] current node values of the volume
+ *  @param  resolution [in] number of nodes along each axis
+ *  @return true if the min/max values can be used for the grid
+ *
+ *  The values must be the array the min/max values were created from, since
+ *  the volume cannot notify the replacement of its values.
+ */
+/*===========================================================================*/
+bool BrickMinMax::isValid( const kvs::AnyValueArray& values, const kvs::Vec3ui& resolution ) const
+{
+    if ( this->isEmpty() ) { return false; }
+    return
+        m_values_data == values.data() &&
+        m_nvalues == values.size() &&
+        m_values_type == values.typeID() &&
+        m_dims[0] + 1 == resolution[0] &&
+        m_dims[1] + 1 == resolution[1] &&
+        m_dims[2] + 1 == resolution[2];
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Creates the min/max values of the bricks.
+ *  @param  values [in] node values (scalar)
+ *  @param  resolution [in] number of nodes along each axis
+ *  @param  brick_size [in] number of cells along each axis of a brick
+ *
+ *  Since a brick includes the nodes shared with the neighboring bricks, its
+ *  range covers all of the values interpolated in its cells. The values are
+ *  rounded outward when they are converted to Real32.
+ */
+/*===========================================================================*/
+void BrickMinMax::create( const kvs::AnyValueArray& values, const kvs::Vec3ui& resolution, const size_t brick_size )
+{
+    this->release();
+    if ( brick_size == 0 || values.size() == 0 ) { return; }
+    if ( resolution[0] < 2 || resolution[1] < 2 || resolution[2] < 2 ) { return; }
+    if ( values.size() != size_t( resolution[0] ) * resolution[1] * resolution[2] )
+    {
+        kvsMessageError() << "The brick min/max values are available only for the scalar volume." << std::endl;
+        return;
+    }
+
+    m_brick_size = brick_size;
+    m_values_data = values.data();
+    m_nvalues = values.size();
+    m_values_type = values.typeID();
+    m_dims = resolution - kvs::Vec3ui( 1, 1, 1 );
+    m_nbricks = kvs::Vec3ui(
+        ( m_dims[0] + brick_size - 1 ) / brick_size,
+        ( m_dims[1] + brick_size - 1 ) / brick_size,
+        ( m_dims[2] + brick_size - 1 ) / brick_size );
+
+    const size_t nbricks = size_t( m_nbricks[0] ) * m_nbricks[1] * m_nbricks[2];
+    m_min_values.allocate( nbricks );
+    m_max_values.allocate( nbricks );
+
+    const ::MinMaxCalculator calculator = { resolution, brick_size, m_nbricks, m_min_values.data(), m_max_values.data() };
+    if ( !YYZVis::DispatchValueType( values, calculator ) ) { this->release(); }
+}
+
+void BrickMinMax::release()
+{
+    m_dims = kvs::Vec3ui( 0, 0, 0 );
+    m_nbricks = kvs::Vec3ui( 0, 0, 0 );
+    m_values_data = NULL;
+    m_nvalues = 0;
+    m_values_type = kvs::Type::UnknownType;
+    m_min_values.release();
+    m_max_values.release();
+}
+
+} // end of namespace YYZVis
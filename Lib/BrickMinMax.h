@@ -0,0 +1,74 @@
+#pragma once
+#include <kvs/Type>
+#include <kvs/Vector3>
+#include <kvs/ValueArray>
+#include <kvs/AnyValueArray>
+
+
+namespace YYZVis
+{
+
+/*===========================================================================*/
+/**
+ *  @brief  Min/max values of the bricks of the cells.
+ *
+ *  The cells of a structured grid are divided into the bricks of
+ *  brickSize()^3 cells, and the min. and max. node values of each brick are
+ *  stored. A mapper can skip the whole brick when its value range does not
+ *  contribute to the result (e.g. zero density or not including the isovalue).
+ *  The min/max values are tied to the node value array they were created from,
+ *  so they become invalid when the values of the volume are replaced.
+ */
+/*===========================================================================*/
+class BrickMinMax
+{
+public:
+    enum { DefaultBrickSize = 8 };
+
+private:
+    size_t m_brick_size; ///< number of cells along each axis of a brick
+    kvs::Vec3ui m_dims; ///< number of cells along each axis
+    kvs::Vec3ui m_nbricks; ///< number of bricks along each axis
+    kvs::ValueArray<kvs::Real32> m_min_values; ///< min. value of each brick
+    kvs::ValueArray<kvs::Real32> m_max_values; ///< max. value of each brick
+    const void* m_values_data; ///< node values used to create the min/max values (reference)
+    size_t m_nvalues; ///< number of the node values
+    kvs::Type::TypeID m_values_type; ///< type of the node values
+
+public:
+    BrickMinMax();
+
+    size_t brickSize() const { return m_brick_size; }
+    const kvs::Vec3ui& dims() const { return m_dims; }
+    const kvs::Vec3ui& numberOfBricks() const { return m_nbricks; }
+    size_t size() const { return m_min_values.size(); }
+    bool isEmpty() const { return m_min_values.size() == 0; }
+    const kvs::ValueArray<kvs::Real32>& minValues() const { return m_min_values; }
+    const kvs::ValueArray<kvs::Real32>& maxValues() const { return m_max_values; }
+    kvs::Real32 minValue( const size_t index ) const { return m_min_values[index]; }
+    kvs::Real32 maxValue( const size_t index ) const { return m_max_values[index]; }
+
+    bool isValid( const kvs::AnyValueArray& values, const kvs::Vec3ui& resolution ) const;
+    size_t brickIndex( const size_t i, const size_t j, const size_t k ) const;
+    void create( const kvs::AnyValueArray& values, const kvs::Vec3ui& resolution, const size_t brick_size = DefaultBrickSize );
+    void release();
+};
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns the index of the brick including the cell (i,j,k).
+ *  @param  i [in] base node index along the first axis
+ *  @param  j [in] base node index along the second axis
+ *  @param  k [in] base node index along the third axis
+ *  @return brick index
+ */
+/*===========================================================================*/
+inline size_t BrickMinMax::brickIndex( const size_t i, const size_t j, const size_t k ) const
+{
+    const size_t bi = i / m_brick_size;
+    const size_t bj = j / m_brick_size;
+    const size_t bk = k / m_brick_size;
+    return bi + m_nbricks[0] * ( bj + m_nbricks[1] * bk );
+}
+
+} // end of namespace YYZVis
@@ -211,6 +211,35 @@ kvs::Real32 DensityMap::at( const float value ) const
     return kvs::Math::Mix( d0, d1, v - s0 );
 }
 
+/*===========================================================================*/
+/**
+ *  @brief  Checks whether the densities are equal to the other map in the range.
+ *  @param  other [in] density map
+ *  @param  s0 [in] min. scalar value of the range
+ *  @param  s1 [in] max. scalar value of the range
+ *  @return true if at() returns the same densities for the values in [s0,s1]
+ */
+/*===========================================================================*/
+bool DensityMap::isEqual( const DensityMap& other, const kvs::Real32 s0, const kvs::Real32 s1 ) const
+{
+    if ( m_table.size() != other.m_table.size() ) { return false; }
+    if ( m_min_value != other.m_min_value || m_max_value != other.m_max_value ) { return false; }
+    if ( m_table.size() == 0 ) { return true; }
+
+    const size_t dims = m_resolution - 1;
+    const kvs::Real32 scale = dims / ( m_max_value - m_min_value );
+    const kvs::Real32 v0 = kvs::Math::Clamp( ( s0 - m_min_value ) * scale, 0.0f, kvs::Real32( dims ) );
+    const kvs::Real32 v1 = kvs::Math::Clamp( ( s1 - m_min_value ) * scale, 0.0f, kvs::Real32( dims ) );
+    const size_t i0 = static_cast<size_t>( v0 );
+    const size_t i1 = kvs::Math::Min( static_cast<size_t>( v1 ) + 1, dims );
+    for ( size_t i = i0; i <= i1; i++ )
+    {
+        if ( m_table[i] != other.m_table[i] ) { return false; }
+    }
+
+    return true;
+}
+
 void DensityMap::create( const kvs::OpacityMap& omap )
 {
     m_resolution = omap.resolution();
@@ -239,22 +268,33 @@ void DensityMap::create( const kvs::OpacityMap& omap )
     }
 }
 
-kvs::Real32 DensityMap::max_density( const kvs::Real32 s0, const kvs::Real32 s1 ) const
+/*===========================================================================*/
+/**
+ *  @brief  Returns the upper bound of the densities in the range.
+ *  @param  s0 [in] min. scalar value of the range
+ *  @param  s1 [in] max. scalar value of the range
+ *  @return max. density of the table entries used by at() for the values in [s0,s1]
+ *
+ *  The returned value is zero only if at() returns zero for all of the values
+ *  in the range, so that the cells in the range can be skipped.
+ */
+/*===========================================================================*/
+kvs::Real32 DensityMap::maxDensity( const kvs::Real32 s0, const kvs::Real32 s1 ) const
 {
-    const kvs::Real32 min_value = this->minValue();
-    const kvs::Real32 max_value = this->maxValue();
-    const size_t dims = this->resolution() - 1;
-    const kvs::Real32 scale = dims / ( max_value - min_value );
-    size_t i0 = static_cast<size_t>( ( s0 - min_value ) * scale );
-    size_t i1 = static_cast<size_t>( ( s1 - min_value ) * scale ) + 1;
-    i0 = kvs::Math::Clamp( i0, size_t(0), dims );
-    i1 = kvs::Math::Clamp( i1, size_t(0), dims );
-
-    kvs::Real32 max_density = this->table().at( i0 );
-    for ( size_t i = i0; i <= i1; i++ )
+    if ( m_table.size() == 0 ) { return 0.0f; }
+    if ( s1 < m_min_value || m_max_value < s0 ) { return 0.0f; }
+
+    const size_t dims = m_resolution - 1;
+    const kvs::Real32 scale = dims / ( m_max_value - m_min_value );
+    const kvs::Real32 v0 = kvs::Math::Clamp( ( s0 - m_min_value ) * scale, 0.0f, kvs::Real32( dims ) );
+    const kvs::Real32 v1 = kvs::Math::Clamp( ( s1 - m_min_value ) * scale, 0.0f, kvs::Real32( dims ) );
+    const size_t i0 = static_cast<size_t>( v0 );
+    const size_t i1 = kvs::Math::Min( static_cast<size_t>( v1 ) + 1, dims );
+
+    kvs::Real32 max_density = m_table[ i0 ];
+    for ( size_t i = i0 + 1; i <= i1; i++ )
     {
-        const kvs::Real32 density =  this->table().at(i);
-        max_density = kvs::Math::Max( max_density, density );
+        max_density = kvs::Math::Max( max_density, m_table[i] );
     }
 
     return max_density;
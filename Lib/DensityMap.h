@@ -40,10 +40,9 @@ public:
 
     kvs::Real32 at( const kvs::Real32 value, const kvs::Real32 overlapweight ) const;
     kvs::Real32 at( const kvs::Real32 value ) const;
+    kvs::Real32 maxDensity( const kvs::Real32 s0, const kvs::Real32 s1 ) const;
+    bool isEqual( const DensityMap& other, const kvs::Real32 s0, const kvs::Real32 s1 ) const;
     void create( const kvs::OpacityMap& omap );
-
-private:
-    kvs::Real32 max_density( const kvs::Real32 s0, const kvs::Real32 s1 ) const;
 };
 
 } // end of namespace YYZVis
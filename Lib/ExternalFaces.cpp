@@ -1,4 +1,5 @@
 #include "ExternalFaces.h"
+#include "ValueType.h"
 
 #define SET_FACE( coord, v1, v2, v3 )           \
     *( coord++ ) = v1.x();                      \
@@ -36,9 +37,9 @@ namespace
  *  @param  color_level [out] pointer to the color indices
  */
 /*===========================================================================*/
-template <const size_t N>
+template <const size_t N, typename ValueType>
 inline void GetColorIndices(
-    const kvs::AnyValueArray& values,
+    const ValueType* values,
     const kvs::Real64 min_value,
     const kvs::Real64 max_value,
     const size_t veclen,
@@ -54,7 +55,7 @@ inline void GetColorIndices(
     {
         for ( size_t i = 0; i < N; i++ )
         {
-            (*color_index)[i] = kvs::UInt32( normalize * ( values.at<kvs::Real64>( node_index[i] ) - min_value ) );
+            (*color_index)[i] = kvs::UInt32( normalize * ( kvs::Real64( values[ node_index[i] ] ) - min_value ) );
         }
     }
     // Vector data.
@@ -66,7 +67,7 @@ inline void GetColorIndices(
         {
             for ( size_t j = 0; j < N; j++ )
             {
-                magnitude[j] += kvs::Math::Square( values.at<kvs::Real64>( veclen * node_index[j] + i ) );
+                magnitude[j] += kvs::Math::Square( kvs::Real64( values[ veclen * node_index[j] + i ] ) );
             }
         }
 
@@ -78,27 +79,6 @@ inline void GetColorIndices(
     }
 }
 
-/*===========================================================================*/
-/**
- *  @brief  Returns coordinate value in yin coordinate or yang coordinate.
- *  @param  volume [in] pointer to yin or yang volume object
- *  @param  x [in] x value of yin coordinate
- *  @param  y [in] y value of yin coordinate
- *  @param  z [in] z value of yin coordinate
- *  @return rotated coordinate value if the given volume is yang volume
- */
-/*===========================================================================*/
-inline kvs::Vec3 GetCoord(
-    const YYZVis::YinYangVolumeObjectBase* volume,
-    const float x,
-    const float y,
-    const float z )
-{
-    return ( volume->gridType() == YYZVis::YinYangVolumeObjectBase::Yin ) ?
-        kvs::Vec3(  x, y, z ) : // Yin
-        kvs::Vec3( -x, z, y ); // Yang = rotated yin
-}
-
 } // end of namespace
 
 
@@ -190,7 +170,7 @@ void ExternalFaces::mapping( const YYZVis::ZhongVolumeObject* zvolume )
 {
     // Calculate coords, colors, and normals.
     this->calculate_coords( zvolume );
-    this->calculate_colors( zvolume );
+    this->calculate_colors( zvolume, zvolume->values() );
 }
 
 /*===========================================================================*/
@@ -203,7 +183,7 @@ void ExternalFaces::mapping( const YYZVis::YinYangVolumeObjectBase* yvolume )
 {
     // Calculate coords, colors, and normals.
     this->calculate_coords( yvolume );
-    this->calculate_colors( yvolume );
+    this->calculate_colors( yvolume, yvolume->values() );
 }
 
 /*===========================================================================*/
@@ -214,23 +194,9 @@ void ExternalFaces::mapping( const YYZVis::YinYangVolumeObjectBase* yvolume )
 /*===========================================================================*/
 void ExternalFaces::calculate_coords( const YYZVis::YinYangVolumeObjectBase* yvolume )
 {
-    const float r_d = yvolume->rangeR().d;
-    const float r_from = yvolume->rangeR().min;
-    const float r_to =  yvolume->rangeR().max;
-
-    const float theta_d = yvolume->rangeTheta().d;
-    const float theta_from =  yvolume->rangeTheta().min;
-//    const float theta_to =  yvolume->rangeTheta().max;
-    const float theta_to =  yvolume->rangeTheta().max + theta_d;
-
-    const float phi_d = yvolume->rangePhi().d;
-    const float phi_from =  yvolume->rangePhi().min;
-//    const float phi_to =  yvolume->rangePhi().max;
-    const float phi_to =  yvolume->rangePhi().max + phi_d;
-
-    const float dim_r = yvolume->dimR();
-    const float dim_theta= yvolume->dimTheta();
-    const float dim_phi = yvolume->dimPhi();
+    const size_t dim_r = yvolume->dimR();
+    const size_t dim_theta= yvolume->dimTheta();
+    const size_t dim_phi = yvolume->dimPhi();
 
     const size_t nfaces =
         ( ( dim_r - 1 ) * ( dim_theta - 1 ) +
@@ -245,43 +211,15 @@ void ExternalFaces::calculate_coords( const YYZVis::YinYangVolumeObjectBase* yvo
 
     // phi = 0
     {
-        const float phi = phi_from;
-        const float sin_phi = std::sin( phi );
-        const float cos_phi = std::cos( phi );
+        const size_t k = 2; // rangePhi().min
         for ( size_t j = 0; j < dim_theta - 1; j++ )
         {
-//            const float theta = theta_from + theta_d * j;
-            const float theta = theta_from + theta_d * ( j - 1 );
-            const float theta_next = theta + theta_d;
-
-            const float sin_theta = std::sin( theta );
-            const float cos_theta = std::cos( theta );
-            const float sin_theta_next = std::sin( theta_next );
-            const float cos_theta_next = std::cos( theta_next );
             for ( size_t i = 0; i < dim_r - 1; i++ )
             {
-                const float r = r_from + r_d * i;
-                const float r_next = r + r_d;
-
-                const float x0 = r * sin_theta * cos_phi;
-                const float y0 = r * sin_theta * sin_phi;
-                const float z0 = r * cos_theta;
-                const kvs::Vec3 v0 = ::GetCoord( yvolume, x0, y0, z0 );
-
-                const float x1 = r_next * sin_theta * cos_phi;
-                const float y1 = r_next * sin_theta * sin_phi;
-                const float z1 = r_next * cos_theta;
-                const kvs::Vec3 v1 = ::GetCoord( yvolume, x1, y1, z1 );
-
-                const float x2 = r_next * sin_theta_next * cos_phi;
-                const float y2 = r_next * sin_theta_next * sin_phi;
-                const float z2 = r_next * cos_theta_next;
-                const kvs::Vec3 v2 = ::GetCoord( yvolume, x2, y2, z2 );
-
-                const float x3 = r * sin_theta_next * cos_phi;
-                const float y3 = r * sin_theta_next * sin_phi;
-                const float z3 = r * cos_theta_next;
-                const kvs::Vec3 v3 = ::GetCoord( yvolume, x3, y3, z3 );
+                const kvs::Vec3 v0 = yvolume->coord( i,     j,     k );
+                const kvs::Vec3 v1 = yvolume->coord( i + 1, j,     k );
+                const kvs::Vec3 v2 = yvolume->coord( i + 1, j + 1, k );
+                const kvs::Vec3 v3 = yvolume->coord( i,     j + 1, k );
 
                 SET_FACE( coord, v3, v2, v1 );
                 SET_FACE( coord, v1, v0, v3 );
@@ -293,43 +231,15 @@ void ExternalFaces::calculate_coords( const YYZVis::YinYangVolumeObjectBase* yvo
 
     // phi = dim_phi - 1
     {
-        const float phi = phi_to;  //grid_size.z() * ( dim_phi - 1 );
-        const float sin_phi = std::sin( phi );
-        const float cos_phi = std::cos( phi );
+        const size_t k = dim_phi - 2; // rangePhi().max + rangePhi().d
         for ( size_t j = 0; j < dim_theta - 1; j++ )
         {
-//            const float theta = theta_from + theta_d * j;
-            const float theta = theta_from + theta_d * ( j - 1 );
-            const float theta_next = theta + theta_d;
-
-            const float sin_theta = std::sin( theta );
-            const float cos_theta = std::cos( theta );
-            const float sin_theta_next = std::sin( theta_next );
-            const float cos_theta_next = std::cos( theta_next );
             for ( size_t i = 0; i < dim_r - 1; i++ )
             {
-                const float r = r_from + r_d * i;
-                const float r_next = r + r_d;
-
-                const float x0 = r * sin_theta * cos_phi;
-                const float y0 = r * sin_theta * sin_phi;
-                const float z0 = r * cos_theta;
-                const kvs::Vec3 v0 = ::GetCoord( yvolume, x0, y0, z0 );
-
-                const float x1 = r_next * sin_theta * cos_phi;
-                const float y1 = r_next * sin_theta * sin_phi;
-                const float z1 = r_next * cos_theta;
-                const kvs::Vec3 v1 = ::GetCoord( yvolume, x1, y1, z1 );
-
-                const float x2 = r_next * sin_theta_next * cos_phi;
-                const float y2 = r_next * sin_theta_next * sin_phi;
-                const float z2 = r_next * cos_theta_next;
-                const kvs::Vec3 v2 = ::GetCoord( yvolume, x2, y2, z2 );
-
-                const float x3 = r * sin_theta_next * cos_phi;
-                const float y3 = r * sin_theta_next * sin_phi;
-                const float z3 = r * cos_theta_next;
-                const kvs::Vec3 v3 = ::GetCoord( yvolume, x3, y3, z3 );
+                const kvs::Vec3 v0 = yvolume->coord( i,     j,     k );
+                const kvs::Vec3 v1 = yvolume->coord( i + 1, j,     k );
+                const kvs::Vec3 v2 = yvolume->coord( i + 1, j + 1, k );
+                const kvs::Vec3 v3 = yvolume->coord( i,     j + 1, k );
 
                 SET_FACE( coord, v0, v1, v2 );
                 SET_FACE( coord, v2, v3, v0 );
@@ -337,49 +247,19 @@ void ExternalFaces::calculate_coords( const YYZVis::YinYangVolumeObjectBase* yvo
                 SET_NORMAL( normal, ( v3 - v2 ).cross( v0 - v2 ) );
             }
         }
+    }
 
-        // r = 0
-        const float r = r_from;
+    // r = 0
+    {
+        const size_t i = 0;
         for  ( size_t j = 0; j < dim_theta - 1; j++ )
         {
-//            const float theta = theta_from + theta_d * j;
-            const float theta = theta_from + theta_d * ( j - 1 );
-            const float theta_next = theta + theta_d;
-
-            const float sin_theta = std::sin( theta );
-            const float cos_theta = std::cos( theta );
-            const float sin_theta_next = std::sin( theta_next );
-            const float cos_theta_next = std::cos( theta_next );
             for ( size_t k = 0; k < dim_phi - 1; k++ )
             {
-//                const float phi = phi_from + phi_d * k;
-                const float phi = phi_from + phi_d * ( k - 2 );
-                const float phi_next = phi + phi_d;
-
-                const float sin_phi = std::sin( phi );
-                const float cos_phi = std::cos( phi );
-                const float sin_phi_next = std::sin( phi_next );
-                const float cos_phi_next = std::cos( phi_next );
-
-                const float x0 = r * sin_theta * cos_phi;
-                const float y0 = r * sin_theta * sin_phi;
-                const float z0 = r * cos_theta;
-                const kvs::Vec3 v0 = ::GetCoord( yvolume, x0, y0, z0 );
-
-                const float x1 = r * sin_theta * cos_phi_next;
-                const float y1 = r * sin_theta * sin_phi_next;
-                const float z1 = r * cos_theta;
-                const kvs::Vec3 v1 = ::GetCoord( yvolume, x1, y1, z1 );
-
-                const float x2 = r * sin_theta_next * cos_phi_next;
-                const float y2 = r * sin_theta_next * sin_phi_next;
-                const float z2 = r * cos_theta_next;
-                const kvs::Vec3 v2 = ::GetCoord( yvolume, x2, y2, z2 );
-
-                const float x3 = r * sin_theta_next * cos_phi;
-                const float y3 = r * sin_theta_next * sin_phi;
-                const float z3 = r * cos_theta_next;
-                const kvs::Vec3 v3 = ::GetCoord( yvolume, x3, y3, z3 );
+                const kvs::Vec3 v0 = yvolume->coord( i, j,     k     );
+                const kvs::Vec3 v1 = yvolume->coord( i, j,     k + 1 );
+                const kvs::Vec3 v2 = yvolume->coord( i, j + 1, k + 1 );
+                const kvs::Vec3 v3 = yvolume->coord( i, j + 1, k     );
 
                 SET_FACE( coord, v0, v1, v2 );
                 SET_FACE( coord, v2, v3, v0 );
@@ -391,47 +271,15 @@ void ExternalFaces::calculate_coords( const YYZVis::YinYangVolumeObjectBase* yvo
 
     // r = dim_r - 1
     {
-        const float r = r_to; //grid_size.x() * ( dim_r - 1 );
+        const size_t i = dim_r - 1;
         for ( size_t j = 0; j < dim_theta - 1; j++ )
         {
-//            const float theta = theta_from + theta_d * j;
-            const float theta = theta_from + theta_d * ( j - 1 );
-            const float theta_next = theta + theta_d;
-
-            const float sin_theta = std::sin( theta );
-            const float cos_theta = std::cos( theta );
-            const float sin_theta_next = std::sin( theta_next );
-            const float cos_theta_next = std::cos( theta_next );
             for ( size_t k = 0; k < dim_phi - 1; k++ )
             {
-//                const float phi = phi_from + phi_d * k;
-                const float phi = phi_from + phi_d * ( k - 2 );
-                const float phi_next = phi + phi_d;
-
-                const float sin_phi = std::sin( phi );
-                const float cos_phi = std::cos( phi );
-                const float sin_phi_next = std::sin( phi_next );
-                const float cos_phi_next = std::cos( phi_next );
-
-                const float x0 = r * sin_theta * cos_phi;
-                const float y0 = r * sin_theta * sin_phi;
-                const float z0 = r * cos_theta;
-                const kvs::Vec3 v0 = ::GetCoord( yvolume, x0, y0, z0 );
-
-                const float x1 = r * sin_theta * cos_phi_next;
-                const float y1 = r * sin_theta * sin_phi_next;
-                const float z1 = r * cos_theta;
-                const kvs::Vec3 v1 = ::GetCoord( yvolume, x1, y1, z1 );
-
-                const float x2 = r * sin_theta_next * cos_phi_next;
-                const float y2 = r * sin_theta_next * sin_phi_next;
-                const float z2 = r * cos_theta_next;
-                const kvs::Vec3 v2 = ::GetCoord( yvolume, x2, y2, z2 );
-
-                const float x3 = r * sin_theta_next * cos_phi;
-                const float y3 = r * sin_theta_next * sin_phi;
-                const float z3 = r * cos_theta_next;
-                const kvs::Vec3 v3 = ::GetCoord( yvolume, x3, y3, z3 );
+                const kvs::Vec3 v0 = yvolume->coord( i, j,     k     );
+                const kvs::Vec3 v1 = yvolume->coord( i, j,     k + 1 );
+                const kvs::Vec3 v2 = yvolume->coord( i, j + 1, k + 1 );
+                const kvs::Vec3 v3 = yvolume->coord( i, j + 1, k     );
 
                 SET_FACE( coord, v3, v2, v1 );
                 SET_FACE( coord, v1, v0, v3 );
@@ -443,43 +291,15 @@ void ExternalFaces::calculate_coords( const YYZVis::YinYangVolumeObjectBase* yvo
 
     // theta = 0
     {
-        const float theta = theta_from;
-        const float sin_theta = std::sin( theta );
-        const float cos_theta = std::cos( theta );
+        const size_t j = 1; // rangeTheta().min
         for ( size_t k = 0; k < dim_phi - 1; k++ )
         {
-//            const float phi = phi_from + phi_d * k;
-            const float phi = phi_from + phi_d * ( k - 2 );
-            const float phi_next = phi + phi_d;
             for ( size_t i = 0; i < dim_r - 1; i++ )
             {
-                const float r = r_from + r_d * i;
-                const float r_next = r + r_d;
-
-                const float sin_phi = std::sin( phi );
-                const float cos_phi = std::cos( phi );
-                const float sin_phi_next = std::sin( phi_next );
-                const float cos_phi_next = std::cos( phi_next );
-
-                const float x0 = r * sin_theta * cos_phi;
-                const float y0 = r * sin_theta * sin_phi;
-                const float z0 = r * cos_theta;
-                const kvs::Vec3 v0 = ::GetCoord( yvolume, x0, y0, z0 );
-
-                const float x1 = r_next * sin_theta * cos_phi;
-                const float y1 = r_next * sin_theta * sin_phi;
-                const float z1 = r_next * cos_theta;
-                const kvs::Vec3 v1 = ::GetCoord( yvolume, x1, y1, z1 );
-
-                const float x2 = r_next * sin_theta * cos_phi_next;
-                const float y2 = r_next * sin_theta * sin_phi_next;
-                const float z2 = r_next * cos_theta;
-                const kvs::Vec3 v2 = ::GetCoord( yvolume, x2, y2, z2 );
-
-                const float x3 = r * sin_theta * cos_phi_next;
-                const float y3 = r * sin_theta * sin_phi_next;
-                const float z3 = r * cos_theta;
-                const kvs::Vec3 v3 = ::GetCoord( yvolume, x3, y3, z3 );
+                const kvs::Vec3 v0 = yvolume->coord( i,     j, k     );
+                const kvs::Vec3 v1 = yvolume->coord( i + 1, j, k     );
+                const kvs::Vec3 v2 = yvolume->coord( i + 1, j, k + 1 );
+                const kvs::Vec3 v3 = yvolume->coord( i,     j, k + 1 );
 
                 SET_FACE( coord, v0, v1, v2 );
                 SET_FACE( coord, v2, v3, v0 );
@@ -491,43 +311,15 @@ void ExternalFaces::calculate_coords( const YYZVis::YinYangVolumeObjectBase* yvo
 
     // theta = dim_theta - 1
     {
-        const float theta = theta_to; //grid_size.y() * ( dim_theta - 1 );
-        const float sin_theta = std::sin( theta );
-        const float cos_theta = std::cos( theta );
+        const size_t j = dim_theta - 1;
         for ( size_t k = 0; k < dim_phi - 1; k++ )
         {
-//            const float phi = phi_from + phi_d * k;
-            const float phi = phi_from + phi_d * ( k - 2 );
-            const float phi_next = phi + phi_d;
             for ( size_t i = 0; i < dim_r - 1; i++ )
             {
-                const float r = r_from + r_d * i;
-                const float r_next = r + r_d;
-
-                const float sin_phi = std::sin( phi );
-                const float cos_phi = std::cos( phi );
-                const float sin_phi_next = std::sin( phi_next );
-                const float cos_phi_next = std::cos( phi_next );
-
-                const float x0 = r * sin_theta * cos_phi;
-                const float y0 = r * sin_theta * sin_phi;
-                const float z0 = r * cos_theta;
-                const kvs::Vec3 v0 = ::GetCoord( yvolume, x0, y0, z0 );
-
-                const float x1 = r_next * sin_theta * cos_phi;
-                const float y1 = r_next * sin_theta * sin_phi;
-                const float z1 = r_next * cos_theta;
-                const kvs::Vec3 v1 = ::GetCoord( yvolume, x1, y1, z1 );
-
-                const float x2 = r_next * sin_theta * cos_phi_next;
-                const float y2 = r_next * sin_theta * sin_phi_next;
-                const float z2 = r_next * cos_theta;
-                const kvs::Vec3 v2 = ::GetCoord( yvolume, x2, y2, z2 );
-
-                const float x3 = r * sin_theta * cos_phi_next;
-                const float y3 = r * sin_theta * sin_phi_next;
-                const float z3 = r * cos_theta;
-                const kvs::Vec3 v3 = ::GetCoord( yvolume, x3, y3, z3 );
+                const kvs::Vec3 v0 = yvolume->coord( i,     j, k     );
+                const kvs::Vec3 v1 = yvolume->coord( i + 1, j, k     );
+                const kvs::Vec3 v2 = yvolume->coord( i + 1, j, k + 1 );
+                const kvs::Vec3 v3 = yvolume->coord( i,     j, k + 1 );
 
                 SET_FACE( coord, v3, v2, v1 );
                 SET_FACE( coord, v1, v0, v3 );
@@ -541,17 +333,50 @@ void ExternalFaces::calculate_coords( const YYZVis::YinYangVolumeObjectBase* yvo
     SuperClass::setNormals( normals );
 }
 
+/*===========================================================================*/
+/**
+ *  @brief  Function object calculating colors from the typed node values.
+ */
+/*===========================================================================*/
+template <typename VolumeObject>
+struct ExternalFaces::ColorCalculator
+{
+    ExternalFaces* mapper; ///< pointer to the mapper
+    const VolumeObject* volume; ///< pointer to the volume object
+
+    template <typename ValueType>
+    void operator ()( const ValueType* values ) const
+    {
+        mapper->calculate_colors( volume, values );
+    }
+};
+
+/*===========================================================================*/
+/**
+ *  @brief  Calculates colors for the value type of the volume object.
+ *  @param  volume [in] pointer to yin/yang or zhong volume object
+ *  @param  values [in] node values of the volume
+ */
+/*===========================================================================*/
+template <typename VolumeObject>
+void ExternalFaces::calculate_colors( const VolumeObject* volume, const kvs::AnyValueArray& values )
+{
+    const ColorCalculator<VolumeObject> calculator = { this, volume };
+    if ( !YYZVis::DispatchValueType( values, calculator ) ) { BaseClass::setSuccess( false ); }
+}
+
 /*===========================================================================*/
 /**
  *  @brief  Calculates colors for yin or yang volume object
- *  @param  zvolume [in] pointer to yin or yang volume object
+ *  @param  yvolume [in] pointer to yin or yang volume object
+ *  @param  value [in] node values of the volume
  */
 /*===========================================================================*/
-void ExternalFaces::calculate_colors( const YYZVis::YinYangVolumeObjectBase* yvolume )
+template <typename ValueType>
+void ExternalFaces::calculate_colors( const YYZVis::YinYangVolumeObjectBase* yvolume, const ValueType* value )
 {
     const kvs::Real64 min_value = yvolume->minValue();
     const kvs::Real64 max_value = yvolume->maxValue();
-    const kvs::AnyValueArray& value =  yvolume->values();
     const size_t veclen = yvolume->veclen();
     const size_t dim_r = yvolume->dimR();
     const size_t dim_theta= yvolume->dimTheta();
@@ -697,7 +522,7 @@ void ExternalFaces::calculate_colors( const YYZVis::YinYangVolumeObjectBase* yvo
 
     // theta = dim_theta - 1
     {
-        const size_t j = dim_theta;
+        const size_t j = dim_theta - 1;
         const size_t offset0 = j * dim_r;
         for ( size_t k = 0, offset = offset0; k < dim_phi - 1; k++, offset = offset0 + k * ( dim_r * dim_theta ) )
         {
@@ -884,14 +709,15 @@ void ExternalFaces::calculate_coords( const YYZVis::ZhongVolumeObject* zvolume )
 /**
  *  @brief  Calculates colors for zhong volume object
  *  @param  zvolume [in] pointer to zhong volume object
+ *  @param  value [in] node values of the volume
  */
 /*===========================================================================*/
-void ExternalFaces::calculate_colors( const YYZVis::ZhongVolumeObject* zvolume )
+template <typename ValueType>
+void ExternalFaces::calculate_colors( const YYZVis::ZhongVolumeObject* zvolume, const ValueType* value )
 {
     // Parameters of the volume data.
     const kvs::Real64 min_value = zvolume->minValue();
     const kvs::Real64 max_value = zvolume->maxValue();
-    const kvs::AnyValueArray& value = zvolume->values();
     const size_t veclen = zvolume->veclen();
     const size_t dim = zvolume->dim();
     const size_t nnodes_per_line = dim;
@@ -29,12 +29,18 @@ public:
     SuperClass* exec( const kvs::ObjectBase* object );
 
 private:
+    template <typename VolumeObject> struct ColorCalculator;
+
     void mapping( const YYZVis::ZhongVolumeObject* zvolume );
     void mapping( const YYZVis::YinYangVolumeObjectBase* yvolume );
     void calculate_coords( const YYZVis::YinYangVolumeObjectBase* yvolume );
-    void calculate_colors( const YYZVis::YinYangVolumeObjectBase* yvolume );
+    template <typename VolumeObject>
+    void calculate_colors( const VolumeObject* volume, const kvs::AnyValueArray& values );
+    template <typename ValueType>
+    void calculate_colors( const YYZVis::YinYangVolumeObjectBase* yvolume, const ValueType* value );
     void calculate_coords( const YYZVis::ZhongVolumeObject* zvolume );
-    void calculate_colors( const YYZVis::ZhongVolumeObject* zvolume );
+    template <typename ValueType>
+    void calculate_colors( const YYZVis::ZhongVolumeObject* zvolume, const ValueType* value );
 };
 
 } // end of namespace YYZVis
@@ -0,0 +1,392 @@
+#include "HexahedralCell.h"
+#include <kvs/Math>
+#include <cstring>
+
+
+namespace
+{
+
+inline kvs::Real32 InterpolateValue( const kvs::Real32* values, const kvs::Real32* weights )
+{
+    return
+        weights[0] * values[0] +
+        weights[1] * values[1] +
+        weights[2] * values[2] +
+        weights[3] * values[3] +
+        weights[4] * values[4] +
+        weights[5] * values[5] +
+        weights[6] * values[6] +
+        weights[7] * values[7];
+}
+
+inline kvs::Vec3 InterpolateCoord( const kvs::Vec3* coords, const kvs::Real32* weights )
+{
+    return
+        weights[0] * coords[0] +
+        weights[1] * coords[1] +
+        weights[2] * coords[2] +
+        weights[3] * coords[3] +
+        weights[4] * coords[4] +
+        weights[5] * coords[5] +
+        weights[6] * coords[6] +
+        weights[7] * coords[7];
+}
+
+}
+
+namespace YYZVis
+{
+
+HexahedralCell::HexahedralCell():
+    m_base_index( 0, 0, 0 )
+{
+    std::memset( m_values, 0, sizeof( kvs::Real32 ) * 8 );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Calculates the interpolation functions at the local point.
+ *  @param  local [in] local point
+ *  @param  N [out] interpolation functions (8 values)
+ */
+/*===========================================================================*/
+void HexahedralCell::InterpolationFunctions( const kvs::Vec3& local, kvs::Real32* N )
+{
+    const float p = local.x();
+    const float q = local.y();
+    const float r = local.z();
+
+    const float pq = p * q;
+    const float qr = q * r;
+    const float rp = r * p;
+    const float pqr = pq * r;
+
+    N[0] = 1.0f - p - q - r + pq + qr + rp - pqr;
+    N[1] = p - pq - rp + pqr;
+    N[2] = pq - pqr;
+    N[3] = q - pq - qr + pqr;
+    N[4] = r - rp - qr + pqr;
+    N[5] = rp - pqr;
+    N[6] = pqr;
+    N[7] = qr - pqr;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Calculates the differential functions at the local point.
+ *  @param  local [in] local point
+ *  @param  dN [out] differential functions (dN/dp, dN/dq and dN/dr; 24 values)
+ */
+/*===========================================================================*/
+void HexahedralCell::DifferentialFunctions( const kvs::Vec3& local, kvs::Real32* dN )
+{
+    const float p = local.x();
+    const float q = local.y();
+    const float r = local.z();
+    const float pq = p * q;
+    const float qr = q * r;
+    const float rp = r * p;
+
+    const size_t nnodes = 8;
+    kvs::Real32* const dNdp = dN;
+    kvs::Real32* const dNdq = dNdp + nnodes;
+    kvs::Real32* const dNdr = dNdq + nnodes;
+
+    dNdp[0] =  - 1.0f + q +r - qr;
+    dNdp[1] =  1.0f - q - r + qr;
+    dNdp[2] =  q - qr;
+    dNdp[3] =  - q + qr;
+    dNdp[4] =  - r + qr;
+    dNdp[5] =  r - qr;
+    dNdp[6] =  qr;
+    dNdp[7] =  - qr;
+
+    dNdq[0] =  - 1.0f + p + r - rp;
+    dNdq[1] =  - p + rp;
+    dNdq[2] =  p - rp;
+    dNdq[3] =  1.0f - p - r + rp;
+    dNdq[4] =  - r + rp;
+    dNdq[5] =  - rp;
+    dNdq[6] =  rp;
+    dNdq[7] =  r - rp;
+
+    dNdr[0] =  - 1.0f + q + p - pq;
+    dNdr[1] =  - p + pq;
+    dNdr[2] =  - pq;
+    dNdr[3] =  - q + pq;
+    dNdr[4] =  1.0f - q - p + pq;
+    dNdr[5] =  p - pq;
+    dNdr[6] =  pq;
+    dNdr[7] =  q - pq;
+}
+
+const kvs::Vec3 HexahedralCell::globalPoint( const kvs::Real32* N ) const
+{
+    return ::InterpolateCoord( m_coords, N );
+}
+
+const kvs::Mat3 HexahedralCell::JacobiMatrix( const kvs::Real32* dN ) const
+{
+    const kvs::UInt32 nnodes = 8;
+    const float* dNdp = dN;
+    const float* dNdq = dNdp + nnodes;
+    const float* dNdr = dNdq + nnodes;
+
+    const kvs::Vec3 dx = ::InterpolateCoord( m_coords, dNdp );
+    const kvs::Vec3 dy = ::InterpolateCoord( m_coords, dNdq );
+    const kvs::Vec3 dz = ::InterpolateCoord( m_coords, dNdr );
+    return kvs::Mat3( dx[0], dy[0], dz[0], dx[1], dy[1], dz[1], dx[2], dy[2], dz[2] );
+}
+
+const kvs::Real32 HexahedralCell::scalar( const kvs::Real32* N ) const
+{
+    return ::InterpolateValue( m_values, N );
+}
+
+const kvs::Vec3 HexahedralCell::gradientVector( const kvs::Real32* dN ) const
+{
+    // Calculate a gradient vector in the local coordinate.
+    const kvs::UInt32 nnodes = 8;
+    const float* dNdp = dN;
+    const float* dNdq = dN + nnodes;
+    const float* dNdr = dN + nnodes + nnodes;
+
+    const float dSdp = ::InterpolateValue( m_values, dNdp );
+    const float dSdq = ::InterpolateValue( m_values, dNdq );
+    const float dSdr = ::InterpolateValue( m_values, dNdr );
+    const kvs::Vec3 g( dSdp, dSdq, dSdr );
+
+    // Calculate a gradient vector in the global coordinate.
+    const kvs::Mat3 J = this->JacobiMatrix( dN );
+    return 3.0f * J.inverted() * g;
+}
+
+const kvs::Vec3 HexahedralCell::globalPoint( const kvs::Vec3& local ) const
+{
+    kvs::Real32 N[8];
+    InterpolationFunctions( local, N );
+    return this->globalPoint( N );
+}
+
+const kvs::Mat3 HexahedralCell::JacobiMatrix( const kvs::Vec3& local ) const
+{
+    kvs::Real32 dN[24];
+    DifferentialFunctions( local, dN );
+    return this->JacobiMatrix( dN );
+}
+
+const kvs::Real32 HexahedralCell::scalar( const kvs::Vec3& local ) const
+{
+    kvs::Real32 N[8];
+    InterpolationFunctions( local, N );
+    return this->scalar( N );
+}
+
+const kvs::Vec3 HexahedralCell::gradientVector( const kvs::Vec3& local ) const
+{
+    kvs::Real32 dN[24];
+    DifferentialFunctions( local, dN );
+    return this->gradientVector( dN );
+}
+
+const kvs::Vec3 HexahedralCell::center() const
+{
+    return (
+        m_coords[0] +
+        m_coords[1] +
+        m_coords[2] +
+        m_coords[3] +
+        m_coords[4] +
+        m_coords[5] +
+        m_coords[6] +
+        m_coords[7] ) / 8.0f;
+}
+
+const kvs::Real32 HexahedralCell::volume() const
+{
+    const size_t resolution = 3;
+    const float sampling_length = 1.0f / (float)resolution;
+    const float adjustment = sampling_length * 0.5f;
+
+    kvs::Vec3 sampling_position( -adjustment, -adjustment, -adjustment );
+
+    float sum_metric = 0;
+    for ( size_t k = 0 ; k < resolution ; k++ )
+    {
+        sampling_position[ 2 ] +=  sampling_length;
+        for( size_t j = 0 ; j < resolution ; j++ )
+        {
+            sampling_position[ 1 ] += sampling_length;
+            for( size_t i = 0 ; i < resolution ; i++ )
+            {
+                sampling_position[ 0 ] += sampling_length;
+
+                const kvs::Mat3 J = this->JacobiMatrix( sampling_position );
+                const float metric_element = J.determinant();
+
+                sum_metric += kvs::Math::Abs<float>( metric_element );
+            }
+            sampling_position[ 0 ] = -adjustment;
+        }
+        sampling_position[ 1 ] = -adjustment;
+    }
+
+    const float resolution3 = resolution * resolution * resolution;
+    return sum_metric / resolution3;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Interpolates the scalar values at n points in SoA layout.
+ *  @param  n [in] number of points
+ *  @param  values [in] node values of the cells (values[l * n + m]: node l of point m)
+ *  @param  p [in] local coordinates along the first axis (n values)
+ *  @param  q [in] local coordinates along the second axis (n values)
+ *  @param  r [in] local coordinates along the third axis (n values)
+ *  @param  scalars [out] interpolated scalar values (n values)
+ *
+ *  Only the interpolation functions are evaluated. The loop has no branches
+ *  and accesses contiguous arrays, so that it is vectorized by the compiler.
+ */
+/*===========================================================================*/
+void HexahedralCell::InterpolateScalars(
+    const size_t n,
+    const kvs::Real32* values,
+    const kvs::Real32* p,
+    const kvs::Real32* q,
+    const kvs::Real32* r,
+    kvs::Real32* scalars )
+{
+    const kvs::Real32* const v0 = values;
+    const kvs::Real32* const v1 = v0 + n;
+    const kvs::Real32* const v2 = v1 + n;
+    const kvs::Real32* const v3 = v2 + n;
+    const kvs::Real32* const v4 = v3 + n;
+    const kvs::Real32* const v5 = v4 + n;
+    const kvs::Real32* const v6 = v5 + n;
+    const kvs::Real32* const v7 = v6 + n;
+    for ( size_t m = 0; m < n; m++ )
+    {
+        const float pq = p[m] * q[m];
+        const float qr = q[m] * r[m];
+        const float rp = r[m] * p[m];
+        const float pqr = pq * r[m];
+
+        const float N0 = 1.0f - p[m] - q[m] - r[m] + pq + qr + rp - pqr;
+        const float N1 = p[m] - pq - rp + pqr;
+        const float N2 = pq - pqr;
+        const float N3 = q[m] - pq - qr + pqr;
+        const float N4 = r[m] - rp - qr + pqr;
+        const float N5 = rp - pqr;
+        const float N6 = pqr;
+        const float N7 = qr - pqr;
+
+        scalars[m] =
+            N0 * v0[m] + N1 * v1[m] + N2 * v2[m] + N3 * v3[m] +
+            N4 * v4[m] + N5 * v5[m] + N6 * v6[m] + N7 * v7[m];
+    }
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Interpolates the gradient vectors at n points in SoA layout.
+ *  @param  n [in] number of points
+ *  @param  values [in] node values of the cells (values[l * n + m]: node l of point m)
+ *  @param  coords [in] node coordinates of the cells (x, y and z of node l of
+ *                      point m are stored in coords[(l + 8c) * n + m], c = 0, 1, 2)
+ *  @param  p [in] local coordinates along the first axis (n values)
+ *  @param  q [in] local coordinates along the second axis (n values)
+ *  @param  r [in] local coordinates along the third axis (n values)
+ *  @param  gx [out] x components of the gradient vectors (n values)
+ *  @param  gy [out] y components of the gradient vectors (n values)
+ *  @param  gz [out] z components of the gradient vectors (n values)
+ *
+ *  The results are same as gradientVector(). The Jacobi matrix is inverted by
+ *  the cofactors in the loop, so that the loop is vectorized by the compiler.
+ */
+/*===========================================================================*/
+void HexahedralCell::InterpolateGradients(
+    const size_t n,
+    const kvs::Real32* values,
+    const kvs::Real32* coords,
+    const kvs::Real32* p,
+    const kvs::Real32* q,
+    const kvs::Real32* r,
+    kvs::Real32* gx,
+    kvs::Real32* gy,
+    kvs::Real32* gz )
+{
+    const kvs::Real32* const X = coords;
+    const kvs::Real32* const Y = coords + 8 * n;
+    const kvs::Real32* const Z = coords + 16 * n;
+    for ( size_t m = 0; m < n; m++ )
+    {
+        const float pq = p[m] * q[m];
+        const float qr = q[m] * r[m];
+        const float rp = r[m] * p[m];
+
+        float dNdp[8], dNdq[8], dNdr[8];
+        dNdp[0] =  - 1.0f + q[m] + r[m] - qr;
+        dNdp[1] =  1.0f - q[m] - r[m] + qr;
+        dNdp[2] =  q[m] - qr;
+        dNdp[3] =  - q[m] + qr;
+        dNdp[4] =  - r[m] + qr;
+        dNdp[5] =  r[m] - qr;
+        dNdp[6] =  qr;
+        dNdp[7] =  - qr;
+
+        dNdq[0] =  - 1.0f + p[m] + r[m] - rp;
+        dNdq[1] =  - p[m] + rp;
+        dNdq[2] =  p[m] - rp;
+        dNdq[3] =  1.0f - p[m] - r[m] + rp;
+        dNdq[4] =  - r[m] + rp;
+        dNdq[5] =  - rp;
+        dNdq[6] =  rp;
+        dNdq[7] =  r[m] - rp;
+
+        dNdr[0] =  - 1.0f + q[m] + p[m] - pq;
+        dNdr[1] =  - p[m] + pq;
+        dNdr[2] =  - pq;
+        dNdr[3] =  - q[m] + pq;
+        dNdr[4] =  1.0f - q[m] - p[m] + pq;
+        dNdr[5] =  p[m] - pq;
+        dNdr[6] =  pq;
+        dNdr[7] =  q[m] - pq;
+
+        // Gradient vector in the local coordinate and Jacobi matrix.
+        float dSdp = 0.0f, dSdq = 0.0f, dSdr = 0.0f;
+        float m00 = 0.0f, m01 = 0.0f, m02 = 0.0f;
+        float m10 = 0.0f, m11 = 0.0f, m12 = 0.0f;
+        float m20 = 0.0f, m21 = 0.0f, m22 = 0.0f;
+        for ( size_t l = 0; l < 8; l++ )
+        {
+            const float v = values[ l * n + m ];
+            const float x = X[ l * n + m ];
+            const float y = Y[ l * n + m ];
+            const float z = Z[ l * n + m ];
+            dSdp += dNdp[l] * v; dSdq += dNdq[l] * v; dSdr += dNdr[l] * v;
+            m00 += dNdp[l] * x; m01 += dNdq[l] * x; m02 += dNdr[l] * x;
+            m10 += dNdp[l] * y; m11 += dNdq[l] * y; m12 += dNdr[l] * y;
+            m20 += dNdp[l] * z; m21 += dNdq[l] * z; m22 += dNdr[l] * z;
+        }
+
+        // Gradient vector in the global coordinate (3 * J^-1 * g).
+        const float c00 = m11 * m22 - m12 * m21;
+        const float c01 = m02 * m21 - m01 * m22;
+        const float c02 = m01 * m12 - m02 * m11;
+        const float c10 = m12 * m20 - m10 * m22;
+        const float c11 = m00 * m22 - m02 * m20;
+        const float c12 = m02 * m10 - m00 * m12;
+        const float c20 = m10 * m21 - m11 * m20;
+        const float c21 = m01 * m20 - m00 * m21;
+        const float c22 = m00 * m11 - m01 * m10;
+        const float det = m00 * c00 + m01 * c10 + m02 * c20;
+        const float s = 3.0f / det;
+
+        gx[m] = s * ( c00 * dSdp + c01 * dSdq + c02 * dSdr );
+        gy[m] = s * ( c10 * dSdp + c11 * dSdq + c12 * dSdr );
+        gz[m] = s * ( c20 * dSdp + c21 * dSdq + c22 * dSdr );
+    }
+}
+
+} // end of namespace YYZVis
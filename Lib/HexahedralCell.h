@@ -0,0 +1,97 @@
+#pragma once
+#include <kvs/Type>
+#include <kvs/Vector3>
+#include <kvs/Matrix33>
+
+
+namespace YYZVis
+{
+
+/*===========================================================================*/
+/**
+ *  @brief  Trilinear hexahedral cell bound to the Yin-Yang or Zhong grid.
+ *
+ *  The cell holds only the node coordinates and values copied at binding, and
+ *  all of the interpolation methods are const and take the local point as an
+ *  argument. A cell can therefore be evaluated concurrently from any number of
+ *  threads, and each thread can keep its own cells and random number generator.
+ */
+/*===========================================================================*/
+class HexahedralCell
+{
+public:
+    enum { NumberOfNodes = 8 };
+
+private:
+    kvs::Vec3ui m_base_index; ///< base index of the bound grid
+    kvs::Vec3 m_coords[8]; ///< node coordinates
+    kvs::Real32 m_values[8]; ///< node values
+
+public:
+    HexahedralCell();
+
+    const kvs::Vec3ui& baseIndex() const { return m_base_index; }
+    const kvs::Vec3& coord( const size_t index ) const { return m_coords[index]; }
+    const kvs::Real32 value( const size_t index ) const { return m_values[index]; }
+    const kvs::Vec3* coords() const { return m_coords; }
+    const kvs::Real32* values() const { return m_values; }
+
+    void setBaseIndex( const kvs::Vec3ui& base_index ) { m_base_index = base_index; }
+    kvs::Vec3* coords() { return m_coords; }
+    kvs::Real32* values() { return m_values; }
+
+    static void InterpolationFunctions( const kvs::Vec3& local, kvs::Real32* N );
+    static void DifferentialFunctions( const kvs::Vec3& local, kvs::Real32* dN );
+
+    const kvs::Vec3 globalPoint( const kvs::Real32* N ) const;
+    const kvs::Mat3 JacobiMatrix( const kvs::Real32* dN ) const;
+    const kvs::Real32 scalar( const kvs::Real32* N ) const;
+    const kvs::Vec3 gradientVector( const kvs::Real32* dN ) const;
+
+    const kvs::Vec3 globalPoint( const kvs::Vec3& local ) const;
+    const kvs::Mat3 JacobiMatrix( const kvs::Vec3& local ) const;
+    const kvs::Real32 scalar( const kvs::Vec3& local ) const;
+    const kvs::Vec3 gradientVector( const kvs::Vec3& local ) const;
+    const kvs::Vec3 center() const;
+    const kvs::Real32 volume() const;
+
+    template <typename RandomNumberGenerator>
+    static const kvs::Vec3 RandomLocalPoint( RandomNumberGenerator& rng );
+
+    static void InterpolateScalars(
+        const size_t n,
+        const kvs::Real32* values,
+        const kvs::Real32* p,
+        const kvs::Real32* q,
+        const kvs::Real32* r,
+        kvs::Real32* scalars );
+
+    static void InterpolateGradients(
+        const size_t n,
+        const kvs::Real32* values,
+        const kvs::Real32* coords,
+        const kvs::Real32* p,
+        const kvs::Real32* q,
+        const kvs::Real32* r,
+        kvs::Real32* gx,
+        kvs::Real32* gy,
+        kvs::Real32* gz );
+};
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns a uniformly distributed local point in the cell.
+ *  @param  rng [in/out] random number generator returning a value in [0,1)
+ *  @return local point
+ */
+/*===========================================================================*/
+template <typename RandomNumberGenerator>
+inline const kvs::Vec3 HexahedralCell::RandomLocalPoint( RandomNumberGenerator& rng )
+{
+    const float p = rng();
+    const float q = rng();
+    const float r = rng();
+    return kvs::Vec3( p, q, r );
+}
+
+} // end of namespace YYZVis
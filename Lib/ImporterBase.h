@@ -8,6 +8,9 @@
 #include <iostream>
 #include <fstream>
 #include <vector>
+#include <algorithm>
+#include <cstring>
+#include "MappedFile.h"
 
 
 namespace YYZVis
@@ -18,17 +21,44 @@ class ImporterBase : public kvs::ImporterBase
     kvsModule( YYZVis::ImporterBase, Importer );
     kvsModuleBaseClass( kvs::ImporterBase );
 
+private:
+    bool m_enable_memory_mapping; ///< flag for reading data files via memory mapping
+
 public:
-    ImporterBase() {}
+    ImporterBase(): m_enable_memory_mapping( true ) {}
+
+    bool isEnabledMemoryMapping() const { return m_enable_memory_mapping; }
+    void setEnabledMemoryMapping( const bool enable ) { m_enable_memory_mapping = enable; }
+    void enableMemoryMapping() { this->setEnabledMemoryMapping( true ); }
+    void disableMemoryMapping() { this->setEnabledMemoryMapping( false ); }
 
 protected:
     bool needsByteSwap( const std::string& endian );
     bool isAbsolutePath( const std::string& data_file );
     std::string absolutePath( const std::string& data_file );
+    std::string dataFilename( const std::string& path_name, const std::string& data_file );
 
     template <typename T>
     kvs::ValueArray<T> readBinary( const std::string& filename, const size_t offset, const bool swap );
 
+    template <typename T>
+    kvs::ValueArray<T> readMappedBinary( const std::string& filename, const size_t offset, const bool swap );
+
+    template <typename T>
+    kvs::ValueArray<T> readStreamBinary( const std::string& filename, const size_t offset, const bool swap );
+
+    template <typename T>
+    size_t numberOfValues( const std::string& filename, const size_t offset );
+
+    template <typename T>
+    bool readBinary( const std::string& filename, const size_t offset, const bool swap, T* dst, const size_t n, const size_t stride );
+
+    template <typename T>
+    kvs::ValueArray<T> readInterleavedBinary( const std::vector<std::string>& filenames, const size_t offset, const bool swap );
+
+    template <typename T>
+    static void CopyBinary( T* dst, const kvs::UInt8* src, const size_t n, const bool swap, const size_t stride = 1 );
+
     template <typename T>
     kvs::ValueArray<T> interleaveArrays( const std::vector<kvs::ValueArray<T>>& arrays );
 };
@@ -56,11 +86,167 @@ inline std::string ImporterBase::absolutePath( const std::string& data_file )
     return kvs::Directory::Absolute( data_file );
 }
 
+inline std::string ImporterBase::dataFilename( const std::string& path_name, const std::string& data_file )
+{
+    return
+        ( this->isAbsolutePath( data_file ) ) ? data_file :
+        ( data_file[0] == '~' ) ? this->absolutePath( data_file ) :
+        path_name + kvs::File::Separator() + data_file;
+}
+
+namespace Internal
+{
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns the word with the byte order reversed.
+ *  @param  v [in] word
+ *  @return swapped word
+ */
+/*===========================================================================*/
+inline kvs::UInt16 ByteSwap( const kvs::UInt16 v )
+{
+    return static_cast<kvs::UInt16>( ( v >> 8 ) | ( v << 8 ) );
+}
+
+inline kvs::UInt32 ByteSwap( const kvs::UInt32 v )
+{
+    return
+        ( v >> 24 ) |
+        ( ( v >> 8 ) & 0x0000FF00u ) |
+        ( ( v << 8 ) & 0x00FF0000u ) |
+        ( v << 24 );
+}
+
+inline kvs::UInt64 ByteSwap( kvs::UInt64 v )
+{
+    v = ( ( v & 0x00000000FFFFFFFFull ) << 32 ) | ( v >> 32 );
+    v = ( ( v & 0x0000FFFF0000FFFFull ) << 16 ) | ( ( v >> 16 ) & 0x0000FFFF0000FFFFull );
+    v = ( ( v & 0x00FF00FF00FF00FFull ) <<  8 ) | ( ( v >>  8 ) & 0x00FF00FF00FF00FFull );
+    return v;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Copies n words to every stride-th element with byte swapping.
+ *  @param  dst [out] destination
+ *  @param  stride [in] stride of the destination in words
+ *  @param  src [in] source (may be unaligned)
+ *  @param  n [in] number of words
+ *
+ *  The loop uses plain loads and shifts so that compilers can turn it into
+ *  vectorized byte shuffles.
+ */
+/*===========================================================================*/
+template <typename Word>
+inline void SwapCopy( Word* dst, const size_t stride, const kvs::UInt8* src, const size_t n )
+{
+    for ( size_t i = 0; i < n; ++i, src += sizeof(Word) )
+    {
+        Word v; std::memcpy( &v, src, sizeof(Word) );
+        dst[ i * stride ] = ByteSwap( v );
+    }
+}
+
+} // end of namespace Internal
+
+/*===========================================================================*/
+/**
+ *  @brief  Copies n values from the raw byte sequence in a single pass.
+ *  @param  dst [out] destination
+ *  @param  src [in] source bytes
+ *  @param  n [in] number of values
+ *  @param  swap [in] if true, byte order is swapped while copying
+ *  @param  stride [in] stride of the destination in values
+ */
+/*===========================================================================*/
+template <typename T>
+inline void ImporterBase::CopyBinary(
+    T* dst,
+    const kvs::UInt8* src,
+    const size_t n,
+    const bool swap,
+    const size_t stride )
+{
+    if ( !swap || sizeof(T) == 1 )
+    {
+        if ( stride == 1 ) { std::memcpy( dst, src, n * sizeof(T) ); return; }
+        for ( size_t i = 0; i < n; ++i, src += sizeof(T) )
+        {
+            std::memcpy( dst + i * stride, src, sizeof(T) );
+        }
+        return;
+    }
+
+    switch ( sizeof(T) )
+    {
+    case 2: Internal::SwapCopy( reinterpret_cast<kvs::UInt16*>( dst ), stride, src, n ); break;
+    case 4: Internal::SwapCopy( reinterpret_cast<kvs::UInt32*>( dst ), stride, src, n ); break;
+    case 8: Internal::SwapCopy( reinterpret_cast<kvs::UInt64*>( dst ), stride, src, n ); break;
+    default:
+        for ( size_t i = 0; i < n; ++i, src += sizeof(T) )
+        {
+            std::memcpy( dst + i * stride, src, sizeof(T) );
+            kvs::Endian::Swap( dst + i * stride, 1 );
+        }
+        break;
+    }
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Reads the payload of a Fortran unformatted sequential record.
+ *  @param  filename [in] filename
+ *  @param  offset [in] size of the record marker placed at both ends in bytes
+ *  @param  swap [in] if true, byte order is swapped
+ *  @return values
+ */
+/*===========================================================================*/
 template <typename T>
 inline kvs::ValueArray<T> ImporterBase::readBinary(
     const std::string& filename,
     const size_t offset,
     const bool swap )
+{
+    if ( m_enable_memory_mapping )
+    {
+        return this->readMappedBinary<T>( filename, offset, swap );
+    }
+
+    return this->readStreamBinary<T>( filename, offset, swap );
+}
+
+template <typename T>
+inline kvs::ValueArray<T> ImporterBase::readMappedBinary(
+    const std::string& filename,
+    const size_t offset,
+    const bool swap )
+{
+    YYZVis::MappedFile file( filename );
+    if ( !file.isOpen() )
+    {
+        // Fall back to the stream reader (e.g. for non-mappable files).
+        return this->readStreamBinary<T>( filename, offset, swap );
+    }
+
+    if ( file.size() < offset * 2 )
+    {
+        kvsMessageError() << "Invalid record size in " << filename << std::endl;
+        return kvs::ValueArray<T>();
+    }
+
+    const size_t data_size = file.size() - offset * 2;
+    kvs::ValueArray<T> values( data_size / sizeof(T) );
+    CopyBinary( values.data(), file.data() + offset, values.size(), swap );
+
+    return values;
+}
+
+template <typename T>
+inline kvs::ValueArray<T> ImporterBase::readStreamBinary(
+    const std::string& filename,
+    const size_t offset,
+    const bool swap )
 {
     std::ifstream ifs( filename.c_str(), std::ifstream::binary );
     if ( !ifs )
@@ -74,13 +260,139 @@ inline kvs::ValueArray<T> ImporterBase::readBinary(
     const size_t data_size = file_size - offset * 2;
 
     ifs.seekg( offset, ifs.beg );
-    kvs::ValueArray<float> values( data_size / sizeof(float) );
+    kvs::ValueArray<T> values( data_size / sizeof(T) );
     ifs.read( reinterpret_cast<char*>( values.data() ), values.byteSize() );
     if ( swap ) { kvs::Endian::Swap( values.data(), values.size() ); }
 
     return values;
 }
 
+/*===========================================================================*/
+/**
+ *  @brief  Returns the number of values stored in the Fortran record.
+ *  @param  filename [in] filename
+ *  @param  offset [in] size of the record marker placed at both ends in bytes
+ *  @return number of values (0 if the file cannot be opened)
+ */
+/*===========================================================================*/
+template <typename T>
+inline size_t ImporterBase::numberOfValues( const std::string& filename, const size_t offset )
+{
+    std::ifstream ifs( filename.c_str(), std::ifstream::binary );
+    if ( !ifs ) { return 0; }
+
+    ifs.seekg( 0, ifs.end );
+    const size_t file_size = ifs.tellg();
+    return file_size > offset * 2 ? ( file_size - offset * 2 ) / sizeof(T) : 0;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Reads the Fortran record into every stride-th element of dst.
+ *  @param  filename [in] filename
+ *  @param  offset [in] size of the record marker placed at both ends in bytes
+ *  @param  swap [in] if true, byte order is swapped
+ *  @param  dst [out] destination (first element of the component)
+ *  @param  n [in] number of values to be read
+ *  @param  stride [in] stride of the destination in values
+ *  @return true if n values have been read successfully
+ *
+ *  The data is streamed in blocks and swapped while being scattered, so that
+ *  no temporary array of the whole record is allocated.
+ */
+/*===========================================================================*/
+template <typename T>
+inline bool ImporterBase::readBinary(
+    const std::string& filename,
+    const size_t offset,
+    const bool swap,
+    T* dst,
+    const size_t n,
+    const size_t stride )
+{
+    if ( m_enable_memory_mapping )
+    {
+        YYZVis::MappedFile file( filename );
+        if ( file.isOpen() )
+        {
+            if ( file.size() < offset * 2 || ( file.size() - offset * 2 ) / sizeof(T) != n )
+            {
+                kvsMessageError() << "Invalid record size in " << filename << std::endl;
+                return false;
+            }
+
+            CopyBinary( dst, file.data() + offset, n, swap, stride );
+            return true;
+        }
+    }
+
+    std::ifstream ifs( filename.c_str(), std::ifstream::binary );
+    if ( !ifs )
+    {
+        kvsMessageError() << "Cannot open " << filename << std::endl;
+        return false;
+    }
+
+    ifs.seekg( 0, ifs.end );
+    const size_t file_size = ifs.tellg();
+    if ( file_size < offset * 2 || ( file_size - offset * 2 ) / sizeof(T) != n )
+    {
+        kvsMessageError() << "Invalid record size in " << filename << std::endl;
+        return false;
+    }
+
+    ifs.seekg( offset, ifs.beg );
+    const size_t block_size = 65536; // number of values per block
+    std::vector<kvs::UInt8> buffer( std::min( n, block_size ) * sizeof(T) );
+    for ( size_t i = 0; i < n; i += block_size )
+    {
+        const size_t m = std::min( n - i, block_size );
+        ifs.read( reinterpret_cast<char*>( buffer.data() ), m * sizeof(T) );
+        if ( !ifs ) { return false; }
+        CopyBinary( dst + i * stride, buffer.data(), m, swap, stride );
+    }
+
+    return true;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Reads the component files into one interleaved value array.
+ *  @param  filenames [in] filenames of the components
+ *  @param  offset [in] size of the record marker placed at both ends in bytes
+ *  @param  swap [in] if true, byte order is swapped
+ *  @return interleaved values (empty if reading failed)
+ */
+/*===========================================================================*/
+template <typename T>
+inline kvs::ValueArray<T> ImporterBase::readInterleavedBinary(
+    const std::vector<std::string>& filenames,
+    const size_t offset,
+    const bool swap )
+{
+    const size_t veclen = filenames.size();
+    if ( veclen == 0 ) { return kvs::ValueArray<T>(); }
+    if ( veclen == 1 ) { return this->readBinary<T>( filenames[0], offset, swap ); }
+
+    const size_t n = this->numberOfValues<T>( filenames[0], offset );
+    if ( n == 0 )
+    {
+        kvsMessageError() << "Cannot read " << filenames[0] << std::endl;
+        return kvs::ValueArray<T>();
+    }
+
+    kvs::ValueArray<T> values( n * veclen );
+    for ( size_t i = 0; i < veclen; ++i )
+    {
+        if ( !this->readBinary<T>( filenames[i], offset, swap, values.data() + i, n, veclen ) )
+        {
+            return kvs::ValueArray<T>();
+        }
+    }
+
+    return values;
+}
+
 template <typename T>
 inline kvs::ValueArray<T> ImporterBase::interleaveArrays( const std::vector<kvs::ValueArray<T>>& arrays )
 {
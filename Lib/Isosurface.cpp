@@ -1,21 +1,503 @@
 #include "Isosurface.h"
+#include "BrickMinMax.h"
+#include "SpanSpaceIndex.h"
+#include "Parallel.h"
+#include "ValueType.h"
+#include "YinYangGrid.h"
+#include "ZhongGrid.h"
 #include <kvs/MarchingHexahedraTable>
 #include <kvs/MarchingCubesTable>
 #include <kvs/Math>
+#include <vector>
+#include <cstring>
+#include <algorithm>
 
 
 namespace
 {
 
-bool HasIgnoreValue( const kvs::AnyValueArray values, const size_t* indices, const double ignore_value = 0.0 )
+bool HasIgnoreValue( const kvs::Real64* cell_values, const double ignore_value = 0.0 )
 {
     for ( size_t i = 0; i < 8; ++i )
     {
-        if ( kvs::Math::Equal( values.at<double>( indices[i] ), ignore_value ) ) { return true; }
+        if ( kvs::Math::Equal( cell_values[i], ignore_value ) ) { return true; }
     }
     return false;
 }
 
+/*===========================================================================*/
+/**
+ *  @brief  Calculates coordinates of the eight nodes of the cell.
+ *  @param  volume [in] pointer to the yin/yang or zhong volume object
+ *  @param  i [in] base node index along the first axis
+ *  @param  j [in] base node index along the second axis
+ *  @param  k [in] base node index along the third axis
+ *  @param  coords [out] coordinates in the order of the local node index
+ */
+/*===========================================================================*/
+template <typename VolumeObject>
+inline void CellCoords(
+    const VolumeObject* volume,
+    const size_t i,
+    const size_t j,
+    const size_t k,
+    kvs::Vec3* coords )
+{
+    coords[0] = volume->coord( i,     j,     k     );
+    coords[1] = volume->coord( i + 1, j,     k     );
+    coords[2] = volume->coord( i + 1, j + 1, k     );
+    coords[3] = volume->coord( i,     j + 1, k     );
+    coords[4] = volume->coord( i,     j,     k + 1 );
+    coords[5] = volume->coord( i + 1, j,     k + 1 );
+    coords[6] = volume->coord( i + 1, j + 1, k + 1 );
+    coords[7] = volume->coord( i,     j + 1, k + 1 );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Gathers the node values of the cell.
+ *  @param  values [in] pointer to the node values of the volume
+ *  @param  local_index [in] node indices of the cell
+ *  @param  cell_values [out] node values in the order of the local node index
+ */
+/*===========================================================================*/
+template <typename ValueType>
+inline void CellValues( const ValueType* values, const size_t* local_index, kvs::Real64* cell_values )
+{
+    for ( size_t l = 0; l < 8; l++ )
+    {
+        cell_values[l] = kvs::Real64( values[ local_index[l] ] );
+    }
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns the flags of the bricks intersected by the isosurfaces.
+ *  @param  bricks [in] min/max values of the bricks
+ *  @param  isolevels [in] isosurface levels
+ *  @return flag of each brick (0 if no isolevel is in the value range)
+ *
+ *  A cell is intersected if one of the node values is greater than the
+ *  isolevel and another one is not, which requires min <= isolevel < max.
+ */
+/*===========================================================================*/
+inline std::vector<kvs::UInt8> ActiveBricks( const YYZVis::BrickMinMax& bricks, const std::vector<double>& isolevels )
+{
+    std::vector<kvs::UInt8> active( bricks.size(), 0 );
+    for ( size_t index = 0; index < bricks.size(); index++ )
+    {
+        for ( size_t level = 0; level < isolevels.size(); level++ )
+        {
+            const double isolevel = isolevels[level];
+            const bool straddle = bricks.minValue( index ) <= isolevel && isolevel < bricks.maxValue( index );
+            if ( straddle ) { active[index] = 1; break; }
+        }
+    }
+    return active;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns the min/max values of the bricks of the volume.
+ *  @param  volume [in] pointer to the yin/yang or zhong volume object
+ *  @param  resolution [in] number of nodes along each axis
+ *  @return min/max values stored on the volume, or created for the volume
+ */
+/*===========================================================================*/
+template <typename VolumeObject>
+inline YYZVis::BrickMinMax Bricks( const VolumeObject* volume, const kvs::Vec3ui& resolution )
+{
+    YYZVis::BrickMinMax bricks = volume->brickMinMax();
+    if ( !bricks.isValid( volume->values(), resolution ) ) { bricks.create( volume->values(), resolution ); }
+    return bricks;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Candidate cells to be intersected by the isosurfaces.
+ *
+ *  If the volume has the span space index, only the active cells found by the
+ *  index are visited. Otherwise, all of the cells are visited except the ones
+ *  in the bricks whose value ranges include no isolevel.
+ */
+/*===========================================================================*/
+class CandidateCells
+{
+private:
+    kvs::Vec3ui m_dims; ///< number of cells along each axis
+    bool m_indexed; ///< true if the span space index is used
+    YYZVis::BrickMinMax m_bricks; ///< min/max values of the bricks
+    std::vector<kvs::UInt8> m_active_bricks; ///< flag of each brick
+    std::vector<kvs::UInt32> m_cells; ///< active cells in ascending order
+    std::vector<size_t> m_layer_offsets; ///< offset of each layer (k) in the active cells
+
+public:
+    template <typename VolumeObject>
+    CandidateCells( const VolumeObject* volume, const kvs::Vec3ui& resolution, const std::vector<double>& isolevels ):
+        m_dims( resolution - kvs::Vec3ui( 1, 1, 1 ) ),
+        m_indexed( volume->spanSpaceIndex().isValid( volume->values(), resolution ) )
+    {
+        if ( m_indexed )
+        {
+            volume->spanSpaceIndex().activeCells( isolevels, &m_cells );
+            const size_t layer_size = size_t( m_dims[0] ) * m_dims[1];
+            m_layer_offsets.resize( m_dims[2] + 1 );
+            for ( size_t k = 0; k <= m_dims[2]; k++ )
+            {
+                const size_t first = layer_size * k;
+                m_layer_offsets[k] = std::lower_bound( m_cells.begin(), m_cells.end(), first ) - m_cells.begin();
+            }
+        }
+        else
+        {
+            m_bricks = ::Bricks( volume, resolution );
+            m_active_bricks = ::ActiveBricks( m_bricks, isolevels );
+        }
+    }
+
+    /*=======================================================================*/
+    /**
+     *  @brief  Calls func(i,j) for each candidate cell (i,j,k) in the layer k.
+     *  @param  k [in] base node index along the third axis
+     *  @param  func [in] function object called with the base node indices
+     */
+    /*=======================================================================*/
+    template <typename Function>
+    void forEach( const size_t k, Function func ) const
+    {
+        if ( m_indexed )
+        {
+            const size_t layer_size = size_t( m_dims[0] ) * m_dims[1];
+            for ( size_t m = m_layer_offsets[k]; m < m_layer_offsets[ k + 1 ]; m++ )
+            {
+                const size_t cell = m_cells[m] - layer_size * k;
+                func( cell % m_dims[0], cell / m_dims[0] );
+            }
+            return;
+        }
+
+        for ( size_t j = 0; j < m_dims[1]; j++ )
+        {
+            for ( size_t i = 0; i < m_dims[0]; i++ )
+            {
+                if ( !m_bricks.isEmpty() && !m_active_bricks[ m_bricks.brickIndex( i, j, k ) ] ) continue;
+                func( i, j );
+            }
+        }
+    }
+};
+
+/*===========================================================================*/
+/**
+ *  @brief  Triangles extracted by a worker.
+ */
+/*===========================================================================*/
+struct Triangles
+{
+    std::vector<kvs::Real32> coords; ///< vertex coordinates
+    std::vector<kvs::Real32> normals; ///< normal vector of each triangle
+    std::vector<kvs::UInt32> levels; ///< isolevel index of each triangle
+};
+
+/*===========================================================================*/
+/**
+ *  @brief  Concatenates the triangles of the workers in order.
+ *  @param  slabs [in] triangles of each slab
+ *  @param  nthreads [in] number of threads
+ *  @param  coords [out] vertex coordinates
+ *  @param  normals [out] normal vectors
+ *  @param  levels [out] isolevel indices
+ *
+ *  The offsets of the slabs are obtained by the prefix sum of their sizes, and
+ *  the slabs are copied in parallel.
+ */
+/*===========================================================================*/
+inline void Concatenate(
+    const std::vector<Triangles>& slabs,
+    const size_t nthreads,
+    kvs::ValueArray<kvs::Real32>* coords,
+    kvs::ValueArray<kvs::Real32>* normals,
+    kvs::ValueArray<kvs::UInt32>* levels )
+{
+    std::vector<size_t> coord_offsets( slabs.size() + 1, 0 );
+    std::vector<size_t> normal_offsets( slabs.size() + 1, 0 );
+    std::vector<size_t> level_offsets( slabs.size() + 1, 0 );
+    for ( size_t k = 0; k < slabs.size(); k++ )
+    {
+        coord_offsets[ k + 1 ] = coord_offsets[k] + slabs[k].coords.size();
+        normal_offsets[ k + 1 ] = normal_offsets[k] + slabs[k].normals.size();
+        level_offsets[ k + 1 ] = level_offsets[k] + slabs[k].levels.size();
+    }
+
+    coords->allocate( coord_offsets.back() );
+    normals->allocate( normal_offsets.back() );
+    levels->allocate( level_offsets.back() );
+    kvs::Real32* const pcoords = coords->data();
+    kvs::Real32* const pnormals = normals->data();
+    kvs::UInt32* const plevels = levels->data();
+    YYZVis::Parallel::For( 0, slabs.size(), [&]( const size_t k )
+    {
+        if ( slabs[k].coords.empty() ) { return; }
+        std::memcpy( pcoords + coord_offsets[k], slabs[k].coords.data(), sizeof( kvs::Real32 ) * slabs[k].coords.size() );
+        std::memcpy( pnormals + normal_offsets[k], slabs[k].normals.data(), sizeof( kvs::Real32 ) * slabs[k].normals.size() );
+        std::memcpy( plevels + level_offsets[k], slabs[k].levels.data(), sizeof( kvs::UInt32 ) * slabs[k].levels.size() );
+    }, nthreads );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns true if the cell has the ignore value (zhong volume).
+ *  @param  cell_values [in] node values of the cell
+ *  @return true if one of the node values is the ignore value
+ */
+/*===========================================================================*/
+inline bool IsIgnoredCell( const YYZVis::ZhongVolumeObject*, const kvs::Real64* cell_values )
+{
+    return HasIgnoreValue( cell_values, 0.0 );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns true if the cell has the ignore value (yin/yang volume).
+ *  @return false, since the yin/yang volume has no ignore value
+ */
+/*===========================================================================*/
+inline bool IsIgnoredCell( const YYZVis::YinYangVolumeObjectBase*, const kvs::Real64* )
+{
+    return false;
+}
+
+// Offsets of the eight nodes from the base node (i,j,k) in the cell.
+const size_t NodeOffset[8][3] = {
+    { 0, 0, 0 }, { 1, 0, 0 }, { 1, 1, 0 }, { 0, 1, 0 },
+    { 0, 0, 1 }, { 1, 0, 1 }, { 1, 1, 1 }, { 0, 1, 1 }
+};
+
+// Vertex ID of the edge on which no vertex has been created yet.
+const kvs::UInt32 NoVertex = 0xffffffff;
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns the local point on the cell edge.
+ *  @param  l0 [in] local node index of the first end of the edge
+ *  @param  l1 [in] local node index of the second end of the edge
+ *  @param  ratio [in] interpolation ratio from the first end
+ *  @return local point in the cell
+ */
+/*===========================================================================*/
+inline kvs::Vec3 EdgeLocalPoint( const int l0, const int l1, const float ratio )
+{
+    const kvs::Vec3 p0( float( NodeOffset[l0][0] ), float( NodeOffset[l0][1] ), float( NodeOffset[l0][2] ) );
+    const kvs::Vec3 p1( float( NodeOffset[l1][0] ), float( NodeOffset[l1][1] ), float( NodeOffset[l1][2] ) );
+    return ( 1.0f - ratio ) * p0 + ratio * p1;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Rolling cache of the vertex IDs on the cell edges.
+ *
+ *  The edges of a layer of the cells (k to k+1) are the edges along the first
+ *  and second axes on the lower and upper node slices, and the edges along
+ *  the third axis between them. When the layer is advanced, the upper slice
+ *  becomes the lower one, so only two slices are kept. Each edge has a slot
+ *  for each isolevel.
+ */
+/*===========================================================================*/
+class EdgeCache
+{
+private:
+    size_t m_dim0; ///< number of nodes along the first axis
+    size_t m_dim1; ///< number of nodes along the second axis
+    size_t m_nlevels; ///< number of isolevels
+    std::vector<kvs::UInt32> m_edges0[2]; ///< edges along the first axis (lower/upper slice)
+    std::vector<kvs::UInt32> m_edges1[2]; ///< edges along the second axis (lower/upper slice)
+    std::vector<kvs::UInt32> m_edges2; ///< edges along the third axis
+
+public:
+    EdgeCache( const size_t dim0, const size_t dim1, const size_t nlevels ):
+        m_dim0( dim0 ),
+        m_dim1( dim1 ),
+        m_nlevels( nlevels )
+    {
+        for ( size_t s = 0; s < 2; s++ )
+        {
+            m_edges0[s].assign( ( dim0 - 1 ) * dim1 * nlevels, NoVertex );
+            m_edges1[s].assign( dim0 * ( dim1 - 1 ) * nlevels, NoVertex );
+        }
+        m_edges2.assign( dim0 * dim1 * nlevels, NoVertex );
+    }
+
+    void advance()
+    {
+        m_edges0[0].swap( m_edges0[1] );
+        m_edges1[0].swap( m_edges1[1] );
+        std::fill( m_edges0[1].begin(), m_edges0[1].end(), NoVertex );
+        std::fill( m_edges1[1].begin(), m_edges1[1].end(), NoVertex );
+        std::fill( m_edges2.begin(), m_edges2.end(), NoVertex );
+    }
+
+    kvs::UInt32& vertex( const size_t i, const size_t j, const int l0, const int l1, const size_t level )
+    {
+        const size_t* o0 = NodeOffset[l0];
+        const size_t* o1 = NodeOffset[l1];
+        const size_t bi = i + std::min( o0[0], o1[0] );
+        const size_t bj = j + std::min( o0[1], o1[1] );
+        const size_t bk = std::min( o0[2], o1[2] );
+        if ( o0[0] != o1[0] ) { return m_edges0[bk][ ( bi + ( m_dim0 - 1 ) * bj ) * m_nlevels + level ]; }
+        if ( o0[1] != o1[1] ) { return m_edges1[bk][ ( bi + m_dim0 * bj ) * m_nlevels + level ]; }
+        return m_edges2[ ( bi + m_dim0 * bj ) * m_nlevels + level ];
+    }
+
+    void slice( const size_t s, std::vector<kvs::UInt32>* ids ) const
+    {
+        ids->assign( m_edges0[s].begin(), m_edges0[s].end() );
+        ids->insert( ids->end(), m_edges1[s].begin(), m_edges1[s].end() );
+    }
+};
+
+/*===========================================================================*/
+/**
+ *  @brief  Indexed triangles extracted by a worker.
+ */
+/*===========================================================================*/
+struct IndexedTriangles
+{
+    std::vector<kvs::Real32> coords; ///< vertex coordinates
+    std::vector<kvs::Real32> normals; ///< normal vector of each vertex or triangle
+    std::vector<kvs::UInt32> connections; ///< vertex IDs of the triangles
+    std::vector<kvs::UInt32> levels; ///< isolevel index of each triangle
+    std::vector<kvs::UInt32> lower_vertices; ///< vertex IDs on the edges of the first node slice
+    std::vector<kvs::UInt32> upper_vertices; ///< vertex IDs on the edges of the last node slice
+};
+
+/*===========================================================================*/
+/**
+ *  @brief  Concatenates the indexed triangles of the workers in order.
+ *  @param  chunks [in] indexed triangles of each chunk
+ *  @param  vertex_normal [in] true if the normals are given for the vertices
+ *  @param  nthreads [in] number of threads
+ *  @param  coords [out] vertex coordinates
+ *  @param  connections [out] vertex IDs of the triangles
+ *  @param  normals [out] normal vectors
+ *  @param  levels [out] isolevel indices
+ *
+ *  The node slice between the neighbouring chunks is the last slice of the
+ *  preceding chunk and the first slice of the following one, so a vertex on
+ *  the slice can be created in both chunks. Such a vertex of the following
+ *  chunk is merged into that of the preceding chunk, whose normal vector
+ *  accumulates the contributions from both sides. The other vertex IDs of
+ *  each chunk are shifted by the number of vertices in the preceding chunks.
+ *  The result is therefore independent of the number of the chunks. The
+ *  vertex normals are normalized at the end.
+ */
+/*===========================================================================*/
+inline void Concatenate(
+    const std::vector<IndexedTriangles>& chunks,
+    const bool vertex_normal,
+    const size_t nthreads,
+    kvs::ValueArray<kvs::Real32>* coords,
+    kvs::ValueArray<kvs::UInt32>* connections,
+    kvs::ValueArray<kvs::Real32>* normals,
+    kvs::ValueArray<kvs::UInt32>* levels )
+{
+    // Map the vertex IDs of each chunk to the global vertex IDs.
+    const size_t nchunks = chunks.size();
+    std::vector< std::vector<kvs::UInt32> > vertex_maps( nchunks );
+    std::vector<size_t> vertex_offsets( nchunks + 1, 0 );
+    for ( size_t c = 0; c < nchunks; c++ )
+    {
+        std::vector<kvs::UInt32>& vertex_map = vertex_maps[c];
+        vertex_map.assign( chunks[c].coords.size() / 3, NoVertex );
+        if ( c > 0 )
+        {
+            const std::vector<kvs::UInt32>& lower = chunks[c].lower_vertices;
+            const std::vector<kvs::UInt32>& upper = chunks[ c - 1 ].upper_vertices;
+            for ( size_t m = 0; m < lower.size(); m++ )
+            {
+                if ( lower[m] == NoVertex || upper[m] == NoVertex ) continue;
+                vertex_map[ lower[m] ] = vertex_maps[ c - 1 ][ upper[m] ];
+            }
+        }
+
+        kvs::UInt32 id = static_cast<kvs::UInt32>( vertex_offsets[c] );
+        for ( size_t v = 0; v < vertex_map.size(); v++ )
+        {
+            if ( vertex_map[v] == NoVertex ) { vertex_map[v] = id++; }
+        }
+        vertex_offsets[ c + 1 ] = id;
+    }
+
+    std::vector<size_t> connection_offsets( nchunks + 1, 0 );
+    std::vector<size_t> level_offsets( nchunks + 1, 0 );
+    for ( size_t c = 0; c < nchunks; c++ )
+    {
+        connection_offsets[ c + 1 ] = connection_offsets[c] + chunks[c].connections.size();
+        level_offsets[ c + 1 ] = level_offsets[c] + chunks[c].levels.size();
+    }
+
+    coords->allocate( vertex_offsets.back() * 3 );
+    normals->allocate( vertex_normal ? vertex_offsets.back() * 3 : level_offsets.back() * 3 );
+    connections->allocate( connection_offsets.back() );
+    levels->allocate( level_offsets.back() );
+    kvs::Real32* const pcoords = coords->data();
+    kvs::Real32* const pnormals = normals->data();
+    kvs::UInt32* const pconnections = connections->data();
+    kvs::UInt32* const plevels = levels->data();
+    YYZVis::Parallel::For( 0, nchunks, [&]( const size_t c )
+    {
+        const std::vector<kvs::UInt32>& vertex_map = vertex_maps[c];
+        for ( size_t v = 0; v < vertex_map.size(); v++ )
+        {
+            if ( vertex_map[v] < vertex_offsets[c] ) continue; // merged vertex
+            std::memcpy( pcoords + 3 * vertex_map[v], chunks[c].coords.data() + 3 * v, sizeof( kvs::Real32 ) * 3 );
+            if ( vertex_normal )
+            {
+                std::memcpy( pnormals + 3 * vertex_map[v], chunks[c].normals.data() + 3 * v, sizeof( kvs::Real32 ) * 3 );
+            }
+        }
+
+        if ( !vertex_normal )
+        {
+            std::memcpy( pnormals + 3 * level_offsets[c], chunks[c].normals.data(), sizeof( kvs::Real32 ) * chunks[c].normals.size() );
+        }
+        std::memcpy( plevels + level_offsets[c], chunks[c].levels.data(), sizeof( kvs::UInt32 ) * chunks[c].levels.size() );
+
+        kvs::UInt32* const p = pconnections + connection_offsets[c];
+        for ( size_t m = 0; m < chunks[c].connections.size(); m++ )
+        {
+            p[m] = vertex_map[ chunks[c].connections[m] ];
+        }
+    }, nthreads );
+
+    if ( !vertex_normal ) { return; }
+
+    // Accumulate the normals of the merged vertices. Each chunk adds only to
+    // the vertices on the last slice of the preceding chunk.
+    YYZVis::Parallel::For( 1, nchunks, [&]( const size_t c )
+    {
+        const std::vector<kvs::UInt32>& vertex_map = vertex_maps[c];
+        for ( size_t v = 0; v < vertex_map.size(); v++ )
+        {
+            if ( vertex_map[v] >= vertex_offsets[c] ) continue;
+            for ( size_t l = 0; l < 3; l++ )
+            {
+                pnormals[ 3 * vertex_map[v] + l ] += chunks[c].normals[ 3 * v + l ];
+            }
+        }
+    }, nthreads );
+
+    // Normalize the accumulated vertex normals.
+    YYZVis::Parallel::For( 0, vertex_offsets.back(), [&]( const size_t v )
+    {
+        kvs::Vec3 normal( pnormals + 3 * v );
+        const float length = normal.length();
+        if ( length > 0.0f ) { normal /= length; }
+        pnormals[ 3 * v + 0 ] = normal.x();
+        pnormals[ 3 * v + 1 ] = normal.y();
+        pnormals[ 3 * v + 2 ] = normal.z();
+    }, nthreads );
+}
+
 } // end of namespace
 
 
@@ -30,8 +512,9 @@ namespace YYZVis
 Isosurface::Isosurface():
     kvs::MapperBase(),
     kvs::PolygonObject(),
-    m_isolevel( 0 ),
-    m_duplication( true )
+    m_isolevels( 1, 0.0 ),
+    m_duplication( true ),
+    m_nthreads( 0 )
 {
 }
 
@@ -53,13 +536,40 @@ Isosurface::Isosurface(
     const kvs::TransferFunction& transfer_function ):
     kvs::MapperBase( transfer_function ),
     kvs::PolygonObject(),
-    m_duplication( duplication )
+    m_duplication( duplication ),
+    m_nthreads( 0 )
 {
     SuperClass::setNormalType( normal_type );
     this->setIsolevel( isolevel );
     this->exec( volume );
 }
 
+/*===========================================================================*/
+/**
+ *  @brief  Constructs a new Isosurface class for several isolevels.
+ *  @param  volume [in] pointer to the volume object
+ *  @param  isolevels [in] levels of the isosurfaces
+ *  @param  normal_type [in] type of the normal vector
+ *  @param  duplication [in] duplication flag
+ *  @param  transfer_function [in] transfer function
+ */
+/*===========================================================================*/
+Isosurface::Isosurface(
+    const kvs::VolumeObjectBase* volume,
+    const std::vector<double>& isolevels,
+    const SuperClass::NormalType normal_type,
+    const bool duplication,
+    const kvs::TransferFunction& transfer_function ):
+    kvs::MapperBase( transfer_function ),
+    kvs::PolygonObject(),
+    m_duplication( duplication ),
+    m_nthreads( 0 )
+{
+    SuperClass::setNormalType( normal_type );
+    this->setIsolevels( isolevels );
+    this->exec( volume );
+}
+
 /*===========================================================================*/
 /**
  *  @brief  Executes the isosurface extraction process.
@@ -92,7 +602,14 @@ Isosurface::SuperClass* Isosurface::exec( const kvs::ObjectBase* object )
         return NULL;
     }
 
-    // In the case of VertexNormal-type, the duplicated vertices are forcibly deleted.
+    if ( m_isolevels.empty() )
+    {
+        BaseClass::setSuccess( false );
+        kvsMessageError() << "No isolevel is specified." << std::endl;
+        return NULL;
+    }
+
+    // In the case of VertexNormal-type, the vertices are forcibly shared by the triangles.
     if ( SuperClass::normalType() == kvs::PolygonObject::VertexNormal )
     {
         m_duplication = false;
@@ -108,7 +625,7 @@ Isosurface::SuperClass* Isosurface::exec( const kvs::ObjectBase* object )
 
     SuperClass::setPolygonType( kvs::PolygonObject::Triangle );
     SuperClass::setColorType( kvs::PolygonObject::PolygonColor );
-    SuperClass::setNormalType( kvs::PolygonObject::PolygonNormal );
+    if ( m_duplication ) { SuperClass::setNormalType( kvs::PolygonObject::PolygonNormal ); }
 
     if ( YYZVis::ZhongVolumeObject::DownCast( volume ) )
     {
@@ -132,26 +649,9 @@ Isosurface::SuperClass* Isosurface::exec( const kvs::ObjectBase* object )
 /*==========================================================================*/
 void Isosurface::mapping( const YYZVis::ZhongVolumeObject* zvolume )
 {
-    // std::vector<kvs::Real32> coords;
-    // std::vector<kvs::Real32> normals;
-
-    // Calculate coords and normals.
-//     if ( m_duplication )
-     {
-        this->extract_surfaces_with_duplication( zvolume );
-     }
-    // else
-    // {
-    //     ...
-    // }
-
-    // const kvs::ColorMap cmap = BaseClass::colorMap();
-    // const kvs::RGBColor color = COLOR_OF_ISOSURFACES;
-
-    // SuperClass::setCoords( coords );
-    // SuperClass::setColor( color );
-    // SuperClass::setNormals( normals );
-    // SuperClass::setOpacity( 255 );
+    const size_t dim = zvolume->dim();
+    const kvs::Vec3ui resolution( dim, dim, dim );
+    this->extract_surfaces<YYZVis::ZhongVolumeObject, YYZVis::ZhongGrid>( zvolume, resolution );
 }
 
 /*==========================================================================*/
@@ -162,129 +662,148 @@ void Isosurface::mapping( const YYZVis::ZhongVolumeObject* zvolume )
 /*==========================================================================*/
 void Isosurface::mapping( const YYZVis::YinYangVolumeObjectBase* yvolume )
 {
-    // std::vector<kvs::Real32> coords;
-    // std::vector<kvs::Real32> normals;
-
-    // Calculate coords and normals.
-//     if ( m_duplication )
-     {
-       this->extract_surfaces_with_duplication( yvolume );
-     }
-    // else
-    // {
-    //     ...
-    // }
-
-    // const kvs::ColorMap cmap = BaseClass::colorMap();
-    // const kvs::RGBColor color = COLOR_OF_ISOSURFACES;
-
-    // SuperClass::setCoords( coords );
-    // SuperClass::setColor( color );
-    // SuperClass::setNormals( normals );
-    // SuperClass::setOpacity( 255 );
+    const kvs::Vec3ui resolution( yvolume->dimR(), yvolume->dimTheta(), yvolume->dimPhi() );
+    this->extract_surfaces<YYZVis::YinYangVolumeObjectBase, YYZVis::YinYangGrid>( yvolume, resolution );
 }
 
-void Isosurface::extract_surfaces_with_duplication( const YYZVis::YinYangVolumeObjectBase* yvolume )
+/*==========================================================================*/
+/**
+ *  @brief  Function object extracting isosurfaces from the typed node values.
+ */
+/*==========================================================================*/
+template <typename VolumeObject, typename Grid>
+struct Isosurface::SurfaceExtractor
+{
+    Isosurface* mapper; ///< pointer to the mapper
+    const VolumeObject* volume; ///< pointer to the volume object
+    kvs::Vec3ui resolution; ///< number of nodes along each axis
+
+    template <typename ValueType>
+    void operator ()( const ValueType* values ) const
+    {
+        mapper->extract_surfaces<VolumeObject, Grid>( volume, resolution, values );
+    }
+};
+
+/*==========================================================================*/
+/**
+ *  @brief  Extracts isosurfaces for the value type of the volume.
+ *  @param  volume [in] pointer to yin/yang or zhong volume object
+ *  @param  resolution [in] number of nodes along each axis
+ *
+ *  The value type is dispatched once here, so the node values are read from
+ *  the typed array in the loops over the cells.
+ */
+/*==========================================================================*/
+template <typename VolumeObject, typename Grid>
+void Isosurface::extract_surfaces( const VolumeObject* volume, const kvs::Vec3ui& resolution )
+{
+    const SurfaceExtractor<VolumeObject, Grid> extractor = { this, volume, resolution };
+    if ( !YYZVis::DispatchValueType( volume->values(), extractor ) ) { BaseClass::setSuccess( false ); }
+}
+
+/*==========================================================================*/
+/**
+ *  @brief  Extracts isosurfaces from the typed node values.
+ *  @param  volume [in] pointer to yin/yang or zhong volume object
+ *  @param  resolution [in] number of nodes along each axis
+ *  @param  values [in] pointer to the node values
+ */
+/*==========================================================================*/
+template <typename VolumeObject, typename Grid, typename ValueType>
+void Isosurface::extract_surfaces( const VolumeObject* volume, const kvs::Vec3ui& resolution, const ValueType* values )
+{
+    if ( m_duplication )
+    {
+        this->extract_surfaces_with_duplication( volume, resolution, values );
+    }
+    else
+    {
+        this->extract_surfaces_without_duplication<VolumeObject, Grid>( volume, resolution, values );
+    }
+}
+
+/*==========================================================================*/
+/**
+ *  @brief  Extracts the triangles from the yin/yang or zhong volume object.
+ *  @param  volume [in] pointer to yin/yang or zhong volume object
+ *  @param  resolution [in] number of nodes along each axis
+ *  @param  values [in] pointer to the node values
+ *
+ *  The cells are partitioned into the slabs along the third axis (phi for the
+ *  yin/yang grid), and the triangles of each slab are extracted by a worker
+ *  into its own buffer, which are then concatenated in the order of the slabs.
+ *  The node values of each cell are read once and classified against all of
+ *  the isolevels.
+ */
+/*==========================================================================*/
+template <typename VolumeObject, typename ValueType>
+void Isosurface::extract_surfaces_with_duplication( const VolumeObject* volume, const kvs::Vec3ui& resolution, const ValueType* values )
 {
-    // Calculated the coordinate data array and the normal vector array.
-    std::vector<kvs::Real32> coords;
-    std::vector<kvs::Real32> normals;
+    const size_t dim0 = resolution[0];
+    const size_t dim1 = resolution[1];
+    const size_t dim2 = resolution[2];
+    const size_t line_size = dim0;
+    const size_t slice_size = dim0 * dim1;
+    const size_t nlevels = m_isolevels.size();
 
-    const size_t dim_r = yvolume->dimR(); // radius
-    const size_t dim_theta = yvolume->dimTheta(); // latitude
-    const size_t dim_phi = yvolume->dimPhi(); // longitude
-    const size_t line_size = dim_r;
-    const size_t slice_size = dim_r * dim_theta;
+    // The cells not intersected by the isosurfaces are skipped.
+    const ::CandidateCells candidates( volume, resolution, m_isolevels );
 
     // Extract surfaces.
-    size_t index = 0;
-    size_t local_index[8] = { 0, 0, 0, 0, 0, 0, 0, 0 };
-    for ( size_t k = 0; k < dim_phi - 1; k++, index += dim_r )
+    std::vector< ::Triangles > slabs( dim2 - 1 );
+    Parallel::For( 0, dim2 - 1, [&]( const size_t k )
     {
-        for ( size_t j = 0; j < dim_theta - 1; j++, index++ )
+        ::Triangles& triangles = slabs[k];
+        candidates.forEach( k, [&]( const size_t i, const size_t j )
         {
-            for ( size_t i = 0; i < dim_r - 1; i++, index++ )
-            {
-                // Calculate the indices of the target cell.
-                local_index[0] = index;
-                local_index[1] = local_index[0] + 1;
-                local_index[2] = local_index[1] + line_size;
-                local_index[3] = local_index[0] + line_size;
-                local_index[4] = local_index[0] + slice_size;
-                local_index[5] = local_index[1] + slice_size;
-                local_index[6] = local_index[2] + slice_size;
-                local_index[7] = local_index[3] + slice_size;
+            const size_t index = i + line_size * j + slice_size * k;
+            size_t local_index[8];
+
+            // Calculate the indices of the target cell.
+            local_index[0] = index;
+            local_index[1] = local_index[0] + 1;
+            local_index[2] = local_index[1] + line_size;
+            local_index[3] = local_index[0] + line_size;
+            local_index[4] = local_index[0] + slice_size;
+            local_index[5] = local_index[1] + slice_size;
+            local_index[6] = local_index[2] + slice_size;
+            local_index[7] = local_index[3] + slice_size;
 
+            kvs::Real64 cell_values[8];
+            ::CellValues( values, local_index, cell_values );
+            if ( ::IsIgnoredCell( volume, cell_values ) ) { return; }
+
+            bool has_coords = false;
+            kvs::Vec3 cell_coords[8];
+            for ( size_t level = 0; level < nlevels; level++ )
+            {
                 // Calculate the index of the reference table.
-                const size_t table_index = this->calculate_table_index( yvolume->values(), local_index );
+                const double isolevel = m_isolevels[level];
+                const size_t table_index = this->calculate_table_index( cell_values, isolevel );
                 if ( table_index == 0 ) continue;
                 if ( table_index == 255 ) continue;
 
+                // Calculate the node coordinates of the target cell.
+                if ( !has_coords ) { ::CellCoords( volume, i, j, k, cell_coords ); has_coords = true; }
+
                 // Calculate the triangle polygons.
-                for ( size_t t = 0; kvs::MarchingHexahedraTable::TriangleID[ table_index ][t] != -1; t += 3 )
-                {
-                    // Refer the edge IDs from the TriangleTable by using the table_index.
-                    const int e0 = kvs::MarchingHexahedraTable::TriangleID[table_index][t];
-                    const int e1 = kvs::MarchingHexahedraTable::TriangleID[table_index][t+2];
-                    const int e2 = kvs::MarchingHexahedraTable::TriangleID[table_index][t+1];
-
-                    // Determine vertices for each edge.
-                    const int p0 = local_index[kvs::MarchingHexahedraTable::VertexID[e0][0]];
-                    const int p1 = local_index[kvs::MarchingHexahedraTable::VertexID[e0][1]];
-
-                    const int p2 = local_index[kvs::MarchingHexahedraTable::VertexID[e1][0]];
-                    const int p3 = local_index[kvs::MarchingHexahedraTable::VertexID[e1][1]];
-
-                    const int p4 = local_index[kvs::MarchingHexahedraTable::VertexID[e2][0]];
-                    const int p5 = local_index[kvs::MarchingHexahedraTable::VertexID[e2][1]];
-
-                    // Calculate coordinates of the vertices which are composed
-                    // of the triangle polygon.
-                    const kvs::Vec3 v0( yvolume->coords().data() + p0 * 3 );
-                    const kvs::Vec3 v1( yvolume->coords().data() + p1 * 3 );
-                    const kvs::Real64 s0 = yvolume->values().at<kvs::Real64>( p0 );
-                    const kvs::Real64 s1 = yvolume->values().at<kvs::Real64>( p1 );
-                    const kvs::Vec3 vertex0( this->interpolate_vertex( v0, v1, s0, s1 ) );
-                    coords.push_back( vertex0.x() );
-                    coords.push_back( vertex0.y() );
-                    coords.push_back( vertex0.z() );
-
-                    const kvs::Vec3 v2( yvolume->coords().data() + p2 * 3 );
-                    const kvs::Vec3 v3( yvolume->coords().data() + p3 * 3 );
-                    const kvs::Real64 s2 = yvolume->values().at<kvs::Real64>( p2 );
-                    const kvs::Real64 s3 = yvolume->values().at<kvs::Real64>( p3 );
-                    const kvs::Vec3 vertex1( this->interpolate_vertex( v2, v3, s2, s3 ) );
-                    coords.push_back( vertex1.x() );
-                    coords.push_back( vertex1.y() );
-                    coords.push_back( vertex1.z() );
-
-                    const kvs::Vec3 v4( yvolume->coords().data() + p4 * 3 );
-                    const kvs::Vec3 v5( yvolume->coords().data() + p5 * 3 );
-                    const kvs::Real64 s4 = yvolume->values().at<kvs::Real64>( p4 );
-                    const kvs::Real64 s5 = yvolume->values().at<kvs::Real64>( p5 );
-                    const kvs::Vec3 vertex2( this->interpolate_vertex( v4, v5, s4, s5 ) );
-                    coords.push_back( vertex2.x() );
-                    coords.push_back( vertex2.y() );
-                    coords.push_back( vertex2.z() );
-
-                    // Calculate a normal vector for the triangle polygon.
-                    const kvs::Vec3 normal( ( vertex1 - vertex0 ).cross( vertex2 - vertex0 ) );
-                    normals.push_back( normal.x() );
-                    normals.push_back( normal.y() );
-                    normals.push_back( normal.z() );
-                } // end of loop-triangle
+                this->extract_triangles( cell_values, isolevel, table_index, cell_coords, &triangles.coords, &triangles.normals );
+                triangles.levels.resize( triangles.normals.size() / 3, kvs::UInt32( level ) );
             }
-        }
-    }
+        } );
+    }, m_nthreads );
 
-    // Calculate the polygon color for the isolevel.
-    const kvs::RGBColor color = this->calculate_color();
+    kvs::ValueArray<kvs::Real32> coords;
+    kvs::ValueArray<kvs::Real32> normals;
+    kvs::ValueArray<kvs::UInt32> levels;
+    ::Concatenate( slabs, m_nthreads, &coords, &normals, &levels );
 
     if ( coords.size() > 0 )
     {
-        SuperClass::setCoords( kvs::ValueArray<kvs::Real32>( coords ) );
-        SuperClass::setNormals( kvs::ValueArray<kvs::Real32>( normals ) );
-        SuperClass::setColor( color );
+        SuperClass::setCoords( coords );
+        SuperClass::setNormals( normals );
+        this->set_colors( levels );
         SuperClass::setOpacity( 255 );
         SuperClass::setPolygonTypeToTriangle();
         SuperClass::setColorTypeToPolygon();
@@ -292,25 +811,62 @@ void Isosurface::extract_surfaces_with_duplication( const YYZVis::YinYangVolumeO
     }
 }
 
-void Isosurface::extract_surfaces_with_duplication( const YYZVis::ZhongVolumeObject* zvolume )
+/*==========================================================================*/
+/**
+ *  @brief  Extracts the indexed triangles whose vertices are shared.
+ *  @param  volume [in] pointer to yin/yang or zhong volume object
+ *  @param  resolution [in] number of nodes along each axis
+ *  @param  values [in] pointer to the node values
+ *
+ *  The vertex on each cell edge is created only once for each isolevel by
+ *  using the rolling edge cache over the two node slices of the current layer
+ *  of the cells, and the triangles refer to the vertices by the connections.
+ *  The layers along the third axis are partitioned into the chunks of
+ *  consecutive layers, one per thread. The vertices created in both chunks on
+ *  the node slice between them are merged when the chunks are concatenated,
+ *  so the vertices, the connections and the vertex normals do not depend on
+ *  the number of threads.
+ *
+ *  In the case of VertexNormal-type, the normal vector of each vertex is the
+ *  negative gradient of the trilinear interpolation averaged over the cells
+ *  sharing the vertex. Otherwise, the normal vector of each triangle is given.
+ */
+/*==========================================================================*/
+template <typename VolumeObject, typename Grid, typename ValueType>
+void Isosurface::extract_surfaces_without_duplication( const VolumeObject* volume, const kvs::Vec3ui& resolution, const ValueType* values )
 {
-    // Calculated the coordinate data array and the normal vector array.
-    std::vector<kvs::Real32> coords;
-    std::vector<kvs::Real32> normals;
+    const size_t dim0 = resolution[0];
+    const size_t dim1 = resolution[1];
+    const size_t dim2 = resolution[2];
+    const size_t line_size = dim0;
+    const size_t slice_size = dim0 * dim1;
+    const size_t nlevels = m_isolevels.size();
+    const bool vertex_normal = SuperClass::normalType() == kvs::PolygonObject::VertexNormal;
+    const Grid grid( volume );
 
-    const size_t dim = zvolume->dim();
-    const size_t line_size = dim;
-    const size_t slice_size = dim * dim;
+    // The cells not intersected by the isosurfaces are skipped.
+    const ::CandidateCells candidates( volume, resolution, m_isolevels );
 
     // Extract surfaces.
-    size_t index = 0;
-    size_t local_index[8];
-    for ( size_t k = 0; k < dim - 1; k++ )
+    const size_t nlayers = dim2 - 1;
+    const size_t nchunks = std::min( m_nthreads > 0 ? m_nthreads : Parallel::NumberOfThreads(), nlayers );
+    std::vector< ::IndexedTriangles > chunks( nchunks );
+    Parallel::For( 0, nchunks, [&]( const size_t c )
     {
-        for ( size_t j = 0; j < dim - 1; j++ )
+        ::IndexedTriangles& triangles = chunks[c];
+        ::EdgeCache cache( dim0, dim1, nlevels );
+        typename Grid::Cell cell;
+
+        const size_t k_begin = nlayers * c / nchunks;
+        const size_t k_end = nlayers * ( c + 1 ) / nchunks;
+        for ( size_t k = k_begin; k < k_end; k++ )
         {
-            for ( size_t i = 0; i < dim - 1; i++ )
+            if ( k > k_begin ) { cache.advance(); }
+            candidates.forEach( k, [&]( const size_t i, const size_t j )
             {
+                const size_t index = i + line_size * j + slice_size * k;
+                size_t local_index[8];
+
                 // Calculate the indices of the target cell.
                 local_index[0] = index;
                 local_index[1] = local_index[0] + 1;
@@ -320,100 +876,190 @@ void Isosurface::extract_surfaces_with_duplication( const YYZVis::ZhongVolumeObj
                 local_index[5] = local_index[1] + slice_size;
                 local_index[6] = local_index[2] + slice_size;
                 local_index[7] = local_index[3] + slice_size;
-                index++;
 
-                if ( ::HasIgnoreValue( zvolume->values(), local_index, 0.0 ) ) { continue; }
-
-                // Calculate the index of the reference table.
-                const size_t table_index = this->calculate_table_index( zvolume->values(), local_index );
-                if ( table_index == 0 ) continue;
-                if ( table_index == 255 ) continue;
+                kvs::Real64 cell_values[8];
+                ::CellValues( values, local_index, cell_values );
+                if ( ::IsIgnoredCell( volume, cell_values ) ) { return; }
 
-                // Calculate the triangle polygons.
-                for ( size_t t = 0; kvs::MarchingHexahedraTable::TriangleID[ table_index ][t] != -1; t += 3 )
+                bool has_cell = false;
+                kvs::Vec3 cell_coords[8];
+                for ( size_t level = 0; level < nlevels; level++ )
                 {
-                    // Refer the edge IDs from the TriangleTable by using the table_index.
-                    const int e0 = kvs::MarchingHexahedraTable::TriangleID[table_index][t];
-                    const int e1 = kvs::MarchingHexahedraTable::TriangleID[table_index][t+2];
-                    const int e2 = kvs::MarchingHexahedraTable::TriangleID[table_index][t+1];
-
-                    // Determine vertices for each edge.
-                    const int p0 = local_index[kvs::MarchingHexahedraTable::VertexID[e0][0]];
-                    const int p1 = local_index[kvs::MarchingHexahedraTable::VertexID[e0][1]];
-
-                    const int p2 = local_index[kvs::MarchingHexahedraTable::VertexID[e1][0]];
-                    const int p3 = local_index[kvs::MarchingHexahedraTable::VertexID[e1][1]];
-
-                    const int p4 = local_index[kvs::MarchingHexahedraTable::VertexID[e2][0]];
-                    const int p5 = local_index[kvs::MarchingHexahedraTable::VertexID[e2][1]];
-
-                    // Calculate coordinates of the vertices which are composed
-                    // of the triangle polygon.
-                    const kvs::Vec3 v0( zvolume->coords().data() + p0 * 3 );
-                    const kvs::Vec3 v1( zvolume->coords().data() + p1 * 3 );
-                    const kvs::Real64 s0 = zvolume->values().at<kvs::Real64>( p0 );
-                    const kvs::Real64 s1 = zvolume->values().at<kvs::Real64>( p1 );
-                    const kvs::Vec3 vertex0( this->interpolate_vertex( v0, v1, s0, s1 ) );
-                    coords.push_back( vertex0.x() );
-                    coords.push_back( vertex0.y() );
-                    coords.push_back( vertex0.z() );
-
-                    const kvs::Vec3 v2( zvolume->coords().data() + p2 * 3 );
-                    const kvs::Vec3 v3( zvolume->coords().data() + p3 * 3 );
-                    const kvs::Real64 s2 = zvolume->values().at<kvs::Real64>( p2 );
-                    const kvs::Real64 s3 = zvolume->values().at<kvs::Real64>( p3 );
-                    const kvs::Vec3 vertex1( this->interpolate_vertex( v2, v3, s2, s3 ) );
-                    coords.push_back( vertex1.x() );
-                    coords.push_back( vertex1.y() );
-                    coords.push_back( vertex1.z() );
-
-                    const kvs::Vec3 v4( zvolume->coords().data() + p4 * 3 );
-                    const kvs::Vec3 v5( zvolume->coords().data() + p5 * 3 );
-                    const kvs::Real64 s4 = zvolume->values().at<kvs::Real64>( p4 );
-                    const kvs::Real64 s5 = zvolume->values().at<kvs::Real64>( p5 );
-                    const kvs::Vec3 vertex2( this->interpolate_vertex( v4, v5, s4, s5 ) );
-                    coords.push_back( vertex2.x() );
-                    coords.push_back( vertex2.y() );
-                    coords.push_back( vertex2.z() );
-
-                    // Calculate a normal vector for the triangle polygon.
-                    const kvs::Vec3 normal( ( vertex1 - vertex0 ).cross( vertex2 - vertex0 ) );
-                    normals.push_back( normal.x() );
-                    normals.push_back( normal.y() );
-                    normals.push_back( normal.z() );
-                } // end of loop-triangle
-            }
+                    // Calculate the index of the reference table.
+                    const double isolevel = m_isolevels[level];
+                    const size_t table_index = this->calculate_table_index( cell_values, isolevel );
+                    if ( table_index == 0 ) continue;
+                    if ( table_index == 255 ) continue;
+
+                    // Calculate the node coordinates of the target cell.
+                    if ( !has_cell )
+                    {
+                        ::CellCoords( volume, i, j, k, cell_coords );
+                        if ( vertex_normal ) { grid.bind( kvs::Vec3ui( i, j, k ), &cell ); }
+                        has_cell = true;
+                    }
+
+                    // Find or create the vertices on the edges intersected by the isosurface.
+                    kvs::UInt32 vertex_ids[12];
+                    for ( size_t e = 0; e < 12; e++ )
+                    {
+                        const int l0 = kvs::MarchingHexahedraTable::VertexID[e][0];
+                        const int l1 = kvs::MarchingHexahedraTable::VertexID[e][1];
+                        const kvs::Real64 s0 = cell_values[l0];
+                        const kvs::Real64 s1 = cell_values[l1];
+                        vertex_ids[e] = ::NoVertex;
+                        if ( ( s0 > isolevel ) == ( s1 > isolevel ) ) continue;
+
+                        const float ratio = static_cast<float>( kvs::Math::Abs( ( isolevel - s0 ) / ( s1 - s0 ) ) );
+                        kvs::UInt32& id = cache.vertex( i, j, l0, l1, level );
+                        if ( id == ::NoVertex )
+                        {
+                            const kvs::Vec3 vertex( ( 1.0f - ratio ) * cell_coords[l0] + ratio * cell_coords[l1] );
+                            id = static_cast<kvs::UInt32>( triangles.coords.size() / 3 );
+                            triangles.coords.push_back( vertex.x() );
+                            triangles.coords.push_back( vertex.y() );
+                            triangles.coords.push_back( vertex.z() );
+                            if ( vertex_normal ) { triangles.normals.insert( triangles.normals.end(), 3, 0.0f ); }
+                        }
+
+                        if ( vertex_normal )
+                        {
+                            const kvs::Vec3 normal = -cell.gradientVector( ::EdgeLocalPoint( l0, l1, ratio ) );
+                            triangles.normals[ 3 * id + 0 ] += normal.x();
+                            triangles.normals[ 3 * id + 1 ] += normal.y();
+                            triangles.normals[ 3 * id + 2 ] += normal.z();
+                        }
+
+                        vertex_ids[e] = id;
+                    }
+
+                    // Calculate the triangle polygons.
+                    for ( size_t t = 0; kvs::MarchingHexahedraTable::TriangleID[ table_index ][t] != -1; t += 3 )
+                    {
+                        const kvs::UInt32 v0 = vertex_ids[ kvs::MarchingHexahedraTable::TriangleID[table_index][t] ];
+                        const kvs::UInt32 v1 = vertex_ids[ kvs::MarchingHexahedraTable::TriangleID[table_index][t+2] ];
+                        const kvs::UInt32 v2 = vertex_ids[ kvs::MarchingHexahedraTable::TriangleID[table_index][t+1] ];
+                        triangles.connections.push_back( v0 );
+                        triangles.connections.push_back( v1 );
+                        triangles.connections.push_back( v2 );
+                        triangles.levels.push_back( kvs::UInt32( level ) );
+
+                        // Calculate a normal vector for the triangle polygon.
+                        if ( !vertex_normal )
+                        {
+                            const kvs::Real32* p = triangles.coords.data();
+                            const kvs::Vec3 vertex0( p + 3 * v0 );
+                            const kvs::Vec3 vertex1( p + 3 * v1 );
+                            const kvs::Vec3 vertex2( p + 3 * v2 );
+                            const kvs::Vec3 normal( ( vertex1 - vertex0 ).cross( vertex2 - vertex0 ) );
+                            triangles.normals.push_back( normal.x() );
+                            triangles.normals.push_back( normal.y() );
+                            triangles.normals.push_back( normal.z() );
+                        }
+                    } // end of loop-triangle
+                } // end of loop-level
+            } );
+
+            // Keep the vertex IDs on the first node slice to merge them with
+            // those of the preceding chunk.
+            if ( k == k_begin && c > 0 ) { cache.slice( 0, &triangles.lower_vertices ); }
         }
-    }
 
-    // Calculate the polygon color for the isolevel.
-    const kvs::RGBColor color = this->calculate_color();
+        // Keep the vertex IDs on the last node slice for the following chunk.
+        if ( c + 1 < nchunks ) { cache.slice( 1, &triangles.upper_vertices ); }
+    }, m_nthreads );
 
-    if ( coords.size() > 0 )
+    kvs::ValueArray<kvs::Real32> coords;
+    kvs::ValueArray<kvs::UInt32> connections;
+    kvs::ValueArray<kvs::Real32> normals;
+    kvs::ValueArray<kvs::UInt32> levels;
+    ::Concatenate( chunks, vertex_normal, m_nthreads, &coords, &connections, &normals, &levels );
+
+    if ( connections.size() > 0 )
     {
-        SuperClass::setCoords( kvs::ValueArray<kvs::Real32>( coords ) );
-        SuperClass::setColor( color );
-        SuperClass::setNormals( kvs::ValueArray<kvs::Real32>( normals ) );
+        SuperClass::setCoords( coords );
+        SuperClass::setConnections( connections );
+        SuperClass::setNormals( normals );
+        this->set_colors( levels );
         SuperClass::setOpacity( 255 );
-        SuperClass::setPolygonType( kvs::PolygonObject::Triangle );
-        SuperClass::setColorType( kvs::PolygonObject::PolygonColor );
-        SuperClass::setNormalType( kvs::PolygonObject::PolygonNormal );
+        SuperClass::setPolygonTypeToTriangle();
+        SuperClass::setColorTypeToPolygon();
+        if ( vertex_normal ) { SuperClass::setNormalTypeToVertex(); }
+        else { SuperClass::setNormalTypeToPolygon(); }
     }
 }
 
-size_t Isosurface::calculate_table_index( const kvs::AnyValueArray values, const size_t* local_index ) const
+/*==========================================================================*/
+/**
+ *  @brief  Extracts the triangles in the cell.
+ *  @param  cell_values [in] node values of the cell
+ *  @param  isolevel [in] isosurface level
+ *  @param  table_index [in] index of the marching hexahedra table
+ *  @param  cell_coords [in] node coordinates of the cell
+ *  @param  coords [out] vertex coordinates of the triangles
+ *  @param  normals [out] normal vectors of the triangles
+ */
+/*==========================================================================*/
+void Isosurface::extract_triangles(
+    const kvs::Real64* cell_values,
+    const double isolevel,
+    const size_t table_index,
+    const kvs::Vec3* cell_coords,
+    std::vector<kvs::Real32>* coords,
+    std::vector<kvs::Real32>* normals ) const
 {
-    const double isolevel = m_isolevel;
+    for ( size_t t = 0; kvs::MarchingHexahedraTable::TriangleID[ table_index ][t] != -1; t += 3 )
+    {
+        // Refer the edge IDs from the TriangleTable by using the table_index.
+        const int e0 = kvs::MarchingHexahedraTable::TriangleID[table_index][t];
+        const int e1 = kvs::MarchingHexahedraTable::TriangleID[table_index][t+2];
+        const int e2 = kvs::MarchingHexahedraTable::TriangleID[table_index][t+1];
+
+        // Determine vertices for each edge.
+        const int l0 = kvs::MarchingHexahedraTable::VertexID[e0][0];
+        const int l1 = kvs::MarchingHexahedraTable::VertexID[e0][1];
+
+        const int l2 = kvs::MarchingHexahedraTable::VertexID[e1][0];
+        const int l3 = kvs::MarchingHexahedraTable::VertexID[e1][1];
+
+        const int l4 = kvs::MarchingHexahedraTable::VertexID[e2][0];
+        const int l5 = kvs::MarchingHexahedraTable::VertexID[e2][1];
+
+        // Calculate coordinates of the vertices which are composed
+        // of the triangle polygon.
+        const kvs::Vec3 vertex0( this->interpolate_vertex( cell_coords[l0], cell_coords[l1], cell_values[l0], cell_values[l1], isolevel ) );
+        const kvs::Vec3 vertex1( this->interpolate_vertex( cell_coords[l2], cell_coords[l3], cell_values[l2], cell_values[l3], isolevel ) );
+        const kvs::Vec3 vertex2( this->interpolate_vertex( cell_coords[l4], cell_coords[l5], cell_values[l4], cell_values[l5], isolevel ) );
+
+        coords->push_back( vertex0.x() );
+        coords->push_back( vertex0.y() );
+        coords->push_back( vertex0.z() );
+        coords->push_back( vertex1.x() );
+        coords->push_back( vertex1.y() );
+        coords->push_back( vertex1.z() );
+        coords->push_back( vertex2.x() );
+        coords->push_back( vertex2.y() );
+        coords->push_back( vertex2.z() );
 
+        // Calculate a normal vector for the triangle polygon.
+        const kvs::Vec3 normal( ( vertex1 - vertex0 ).cross( vertex2 - vertex0 ) );
+        normals->push_back( normal.x() );
+        normals->push_back( normal.y() );
+        normals->push_back( normal.z() );
+    } // end of loop-triangle
+}
+
+size_t Isosurface::calculate_table_index( const kvs::Real64* cell_values, const double isolevel ) const
+{
     size_t table_index = 0;
-    if ( values.at<double>( local_index[0] ) > isolevel ) { table_index |=   1; }
-    if ( values.at<double>( local_index[1] ) > isolevel ) { table_index |=   2; }
-    if ( values.at<double>( local_index[2] ) > isolevel ) { table_index |=   4; }
-    if ( values.at<double>( local_index[3] ) > isolevel ) { table_index |=   8; }
-    if ( values.at<double>( local_index[4] ) > isolevel ) { table_index |=  16; }
-    if ( values.at<double>( local_index[5] ) > isolevel ) { table_index |=  32; }
-    if ( values.at<double>( local_index[6] ) > isolevel ) { table_index |=  64; }
-    if ( values.at<double>( local_index[7] ) > isolevel ) { table_index |= 128; }
+    if ( cell_values[0] > isolevel ) { table_index |=   1; }
+    if ( cell_values[1] > isolevel ) { table_index |=   2; }
+    if ( cell_values[2] > isolevel ) { table_index |=   4; }
+    if ( cell_values[3] > isolevel ) { table_index |=   8; }
+    if ( cell_values[4] > isolevel ) { table_index |=  16; }
+    if ( cell_values[5] > isolevel ) { table_index |=  32; }
+    if ( cell_values[6] > isolevel ) { table_index |=  64; }
+    if ( cell_values[7] > isolevel ) { table_index |= 128; }
 
     return table_index;
 }
@@ -422,19 +1068,54 @@ const kvs::Vec3 Isosurface::interpolate_vertex(
     const kvs::Vec3& vertex0,
     const kvs::Vec3& vertex1,
     const double value0,
-    const double value1 ) const
+    const double value1,
+    const double isolevel ) const
 {
-    const float ratio = static_cast<float>( kvs::Math::Abs( ( m_isolevel - value0 ) / ( value1 - value0 ) ) );
+    const float ratio = static_cast<float>( kvs::Math::Abs( ( isolevel - value0 ) / ( value1 - value0 ) ) );
     return ( 1.0f - ratio ) * vertex0 + ratio * vertex1;
 }
 
-const kvs::RGBColor Isosurface::calculate_color()
+const kvs::RGBColor Isosurface::calculate_color( const double isolevel )
 {
     const kvs::Real64 min_value = BaseClass::volume()->minValue();
     const kvs::Real64 max_value = BaseClass::volume()->maxValue();
     const kvs::Real64 normalize_factor = 255.0 / ( max_value - min_value );
-    const kvs::UInt8 index = static_cast<kvs::UInt8>( normalize_factor * ( m_isolevel - min_value ) );
+    const kvs::UInt8 index = static_cast<kvs::UInt8>( normalize_factor * ( isolevel - min_value ) );
     return BaseClass::transferFunction().colorMap()[ index ];
 }
 
+/*==========================================================================*/
+/**
+ *  @brief  Sets the polygon colors for the isolevels.
+ *  @param  levels [in] isolevel index of each triangle
+ *
+ *  A single color is set for a single isolevel. Otherwise, the color of the
+ *  isolevel is set for each triangle.
+ */
+/*==========================================================================*/
+void Isosurface::set_colors( const kvs::ValueArray<kvs::UInt32>& levels )
+{
+    if ( m_isolevels.size() == 1 )
+    {
+        SuperClass::setColor( this->calculate_color( m_isolevels[0] ) );
+        return;
+    }
+
+    std::vector<kvs::RGBColor> level_colors( m_isolevels.size() );
+    for ( size_t level = 0; level < m_isolevels.size(); level++ )
+    {
+        level_colors[level] = this->calculate_color( m_isolevels[level] );
+    }
+
+    kvs::ValueArray<kvs::UInt8> colors( levels.size() * 3 );
+    for ( size_t index = 0; index < levels.size(); index++ )
+    {
+        const kvs::RGBColor& color = level_colors[ levels[index] ];
+        colors[ 3 * index + 0 ] = color.r();
+        colors[ 3 * index + 1 ] = color.g();
+        colors[ 3 * index + 2 ] = color.b();
+    }
+    SuperClass::setColors( colors );
+}
+
 } // end of namespace YYZVis
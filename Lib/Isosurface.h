@@ -4,6 +4,7 @@
 #include <kvs/PolygonObject>
 #include <kvs/VolumeObjectBase>
 #include <kvs/TransferFunction>
+#include <vector>
 #include "YinYangVolumeObjectBase.h"
 #include "ZhongVolumeObject.h"
 
@@ -14,6 +15,9 @@ namespace YYZVis
 /*===========================================================================*/
 /**
  *  @brief  Isosurface extraction class.
+ *
+ *  Several isolevels can be given, for which the cells are traversed once and
+ *  each triangle is colored by its isolevel.
  */
 /*===========================================================================*/
 class Isosurface : public kvs::MapperBase, public kvs::PolygonObject
@@ -23,8 +27,9 @@ class Isosurface : public kvs::MapperBase, public kvs::PolygonObject
     kvsModuleSuperClass( kvs::PolygonObject );
 
 private:
-    double m_isolevel; ///< isosurface level
-    bool m_duplication; ///< duplication flag (not available)
+    std::vector<double> m_isolevels; ///< isosurface levels
+    bool m_duplication; ///< duplication flag (false: vertices are shared by the triangles)
+    size_t m_nthreads; ///< number of threads (0: number of hardware threads)
 
 public:
     Isosurface();
@@ -34,18 +39,46 @@ public:
         const SuperClass::NormalType normal_type,
         const bool duplication,
         const kvs::TransferFunction& transfer_function );
+    Isosurface(
+        const kvs::VolumeObjectBase* volume,
+        const std::vector<double>& isolevels,
+        const SuperClass::NormalType normal_type,
+        const bool duplication,
+        const kvs::TransferFunction& transfer_function );
 
-    void setIsolevel( const double isolevel ) { m_isolevel = isolevel; }
+    const std::vector<double>& isolevels() const { return m_isolevels; }
+    size_t numberOfThreads() const { return m_nthreads; }
+    bool isDuplication() const { return m_duplication; }
+    void setDuplication( const bool duplication ) { m_duplication = duplication; }
+    void setIsolevel( const double isolevel ) { m_isolevels.assign( 1, isolevel ); }
+    void setIsolevels( const std::vector<double>& isolevels ) { m_isolevels = isolevels; }
+    void setNumberOfThreads( const size_t nthreads ) { m_nthreads = nthreads; }
     SuperClass* exec( const kvs::ObjectBase* object );
 
 private:
+    template <typename VolumeObject, typename Grid> struct SurfaceExtractor;
+
     void mapping( const YYZVis::ZhongVolumeObject* zvolume );
     void mapping( const YYZVis::YinYangVolumeObjectBase* yvolume );
-    void extract_surfaces_with_duplication( const YYZVis::YinYangVolumeObjectBase* yvolume );
-    void extract_surfaces_with_duplication( const YYZVis::ZhongVolumeObject* zvolume );
-    size_t calculate_table_index( const kvs::AnyValueArray values, const size_t* local_index ) const;
-    const kvs::Vec3 interpolate_vertex( const kvs::Vec3& vertex0, const kvs::Vec3& vertex1, const double value0, const double value1 ) const;
-    const kvs::RGBColor calculate_color();
+    template <typename VolumeObject, typename Grid>
+    void extract_surfaces( const VolumeObject* volume, const kvs::Vec3ui& resolution );
+    template <typename VolumeObject, typename Grid, typename ValueType>
+    void extract_surfaces( const VolumeObject* volume, const kvs::Vec3ui& resolution, const ValueType* values );
+    template <typename VolumeObject, typename ValueType>
+    void extract_surfaces_with_duplication( const VolumeObject* volume, const kvs::Vec3ui& resolution, const ValueType* values );
+    template <typename VolumeObject, typename Grid, typename ValueType>
+    void extract_surfaces_without_duplication( const VolumeObject* volume, const kvs::Vec3ui& resolution, const ValueType* values );
+    void extract_triangles(
+        const kvs::Real64* cell_values,
+        const double isolevel,
+        const size_t table_index,
+        const kvs::Vec3* cell_coords,
+        std::vector<kvs::Real32>* coords,
+        std::vector<kvs::Real32>* normals ) const;
+    size_t calculate_table_index( const kvs::Real64* cell_values, const double isolevel ) const;
+    const kvs::Vec3 interpolate_vertex( const kvs::Vec3& vertex0, const kvs::Vec3& vertex1, const double value0, const double value1, const double isolevel ) const;
+    const kvs::RGBColor calculate_color( const double isolevel );
+    void set_colors( const kvs::ValueArray<kvs::UInt32>& levels );
 };
 
 } // end of namespace YYZVis
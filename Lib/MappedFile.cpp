@@ -0,0 +1,119 @@
+#include "MappedFile.h"
+#include <kvs/Platform>
+#if defined( KVS_PLATFORM_WINDOWS )
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+
+namespace YYZVis
+{
+
+MappedFile::MappedFile():
+    m_data( NULL ),
+    m_size( 0 )
+{
+}
+
+MappedFile::MappedFile( const std::string& filename ):
+    m_data( NULL ),
+    m_size( 0 )
+{
+    this->open( filename );
+}
+
+MappedFile::~MappedFile()
+{
+    this->close();
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Maps the whole file into memory for reading.
+ *  @param  filename [in] filename
+ *  @return true if the file has been mapped successfully
+ *
+ *  No error message is output on failure since the callers fall back to
+ *  reading the file as a stream, which reports the error if it also fails.
+ */
+/*===========================================================================*/
+bool MappedFile::open( const std::string& filename )
+{
+    this->close();
+
+#if defined( KVS_PLATFORM_WINDOWS )
+    HANDLE file = ::CreateFileA(
+        filename.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+        OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL );
+    if ( file == INVALID_HANDLE_VALUE ) { return false; }
+
+    LARGE_INTEGER file_size;
+    if ( !::GetFileSizeEx( file, &file_size ) || file_size.QuadPart == 0 )
+    {
+        ::CloseHandle( file );
+        return false;
+    }
+
+    // The view keeps the underlying file and mapping objects alive, so both
+    // handles can be released right after the view has been created.
+    HANDLE mapping = ::CreateFileMappingA( file, NULL, PAGE_READONLY, 0, 0, NULL );
+    ::CloseHandle( file );
+    if ( !mapping ) { return false; }
+
+    void* data = ::MapViewOfFile( mapping, FILE_MAP_READ, 0, 0, 0 );
+    ::CloseHandle( mapping );
+    if ( !data ) { return false; }
+
+    m_data = static_cast<const kvs::UInt8*>( data );
+    m_size = static_cast<size_t>( file_size.QuadPart );
+#else
+    const int fd = ::open( filename.c_str(), O_RDONLY );
+    if ( fd < 0 ) { return false; }
+
+    struct stat st;
+    if ( ::fstat( fd, &st ) != 0 || st.st_size == 0 )
+    {
+        ::close( fd );
+        return false;
+    }
+
+    // The mapping remains valid after the descriptor has been closed.
+    void* data = ::mmap( NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+    ::close( fd );
+    if ( data == MAP_FAILED ) { return false; }
+
+#if defined( MADV_SEQUENTIAL )
+    ::madvise( data, st.st_size, MADV_SEQUENTIAL );
+#endif
+
+    m_data = static_cast<const kvs::UInt8*>( data );
+    m_size = static_cast<size_t>( st.st_size );
+#endif
+
+    return true;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Unmaps the file.
+ */
+/*===========================================================================*/
+void MappedFile::close()
+{
+    if ( !m_data ) { return; }
+
+#if defined( KVS_PLATFORM_WINDOWS )
+    ::UnmapViewOfFile( m_data );
+#else
+    ::munmap( const_cast<kvs::UInt8*>( m_data ), m_size );
+#endif
+
+    m_data = NULL;
+    m_size = 0;
+}
+
+} // end of namespace YYZVis
@@ -0,0 +1,38 @@
+#pragma once
+#include <string>
+#include <cstddef>
+#include <kvs/Type>
+
+
+namespace YYZVis
+{
+
+/*===========================================================================*/
+/**
+ *  @brief  Read-only memory-mapped file.
+ */
+/*===========================================================================*/
+class MappedFile
+{
+private:
+    const kvs::UInt8* m_data; ///< pointer to the mapped region
+    size_t m_size; ///< size of the mapped region in bytes
+
+public:
+    MappedFile();
+    MappedFile( const std::string& filename );
+    ~MappedFile();
+
+    bool isOpen() const { return m_data != NULL; }
+    size_t size() const { return m_size; }
+    const kvs::UInt8* data() const { return m_data; }
+
+    bool open( const std::string& filename );
+    void close();
+
+private:
+    MappedFile( const MappedFile& );
+    MappedFile& operator =( const MappedFile& );
+};
+
+} // end of namespace YYZVis
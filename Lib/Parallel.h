@@ -0,0 +1,71 @@
+#pragma once
+#include <cstddef>
+#include <thread>
+#include <atomic>
+#include <vector>
+#include <algorithm>
+
+
+namespace YYZVis
+{
+
+namespace Parallel
+{
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns the number of hardware threads.
+ *  @return number of threads (at least 1)
+ */
+/*===========================================================================*/
+inline size_t NumberOfThreads()
+{
+    const size_t nthreads = std::thread::hardware_concurrency();
+    return nthreads > 0 ? nthreads : 1;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Executes func(index) for each index in [begin, end) in parallel.
+ *  @param  begin [in] first index
+ *  @param  end [in] last index (not included)
+ *  @param  func [in] function object called with the index
+ *  @param  nthreads [in] maximum number of threads (0: number of hardware threads)
+ *
+ *  The indices are distributed dynamically to a bounded set of workers, so
+ *  tasks with unbalanced costs (e.g. reading files of different sizes) are
+ *  handled efficiently.
+ */
+/*===========================================================================*/
+template <typename Function>
+inline void For( const size_t begin, const size_t end, Function func, const size_t nthreads = 0 )
+{
+    if ( begin >= end ) { return; }
+
+    const size_t ntasks = end - begin;
+    const size_t nworkers = std::min( nthreads > 0 ? nthreads : NumberOfThreads(), ntasks );
+    if ( nworkers <= 1 )
+    {
+        for ( size_t index = begin; index < end; ++index ) { func( index ); }
+        return;
+    }
+
+    std::atomic<size_t> counter( begin );
+    auto worker = [&]()
+    {
+        for ( size_t index = counter++; index < end; index = counter++ )
+        {
+            func( index );
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve( nworkers - 1 );
+    for ( size_t i = 1; i < nworkers; ++i ) { threads.emplace_back( worker ); }
+    worker();
+    for ( auto& thread : threads ) { thread.join(); }
+}
+
+} // end of namespace Parallel
+
+} // end of namespace YYZVis
@@ -0,0 +1,211 @@
+#pragma once
+#include "BrickMinMax.h"
+#include "DensityMap.h"
+#include <kvs/ValueArray>
+#include <kvs/ColorMap>
+#include <kvs/Vector3>
+#include <kvs/Assert>
+#include <vector>
+#include <cstring>
+
+
+namespace YYZVis
+{
+
+namespace Internal
+{
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns the flags of the bricks where particles can be generated.
+ *  @param  bricks [in] min/max values of the bricks
+ *  @param  density_map [in] density map
+ *  @return flag of each brick (0 if the densities are zero in the brick)
+ */
+/*===========================================================================*/
+inline std::vector<kvs::UInt8> ActiveBricks( const YYZVis::BrickMinMax& bricks, const YYZVis::DensityMap& density_map )
+{
+    std::vector<kvs::UInt8> active( bricks.size() );
+    for ( size_t index = 0; index < bricks.size(); index++ )
+    {
+        const kvs::Real32 density = density_map.maxDensity( bricks.minValue( index ), bricks.maxValue( index ) );
+        active[index] = kvs::UInt8( density > 0.0f ? 1 : 0 );
+    }
+    return active;
+}
+
+struct Particle
+{
+    kvs::Vec3 coord; ///< coordinate value
+    kvs::Vec3 normal; ///< normal vector
+    kvs::Real32 scalar; ///< scalar value
+};
+
+/*===========================================================================*/
+/**
+ *  @brief  Particles written into a slice of the preallocated arrays.
+ */
+/*===========================================================================*/
+class Particles
+{
+private:
+    kvs::Real32* m_coords; ///< coorinate value array of the slice
+    kvs::Real32* m_normals; ///< normal vector array of the slice
+    kvs::UInt8* m_colors; ///< color value array of the slice
+    size_t m_capacity; ///< max. number of particles in the slice
+    size_t m_size; ///< number of written particles
+
+public:
+    Particles():
+        m_coords( NULL ),
+        m_normals( NULL ),
+        m_colors( NULL ),
+        m_capacity( 0 ),
+        m_size( 0 ) {}
+
+    Particles( kvs::Real32* coords, kvs::Real32* normals, kvs::UInt8* colors, const size_t capacity ):
+        m_coords( coords ),
+        m_normals( normals ),
+        m_colors( colors ),
+        m_capacity( capacity ),
+        m_size( 0 ) {}
+
+    size_t size() const { return m_size; }
+    void push( const kvs::Real32* coords, const kvs::Real32* normals, const kvs::UInt8* colors, const size_t n )
+    {
+        KVS_ASSERT( m_size + n <= m_capacity );
+        const size_t offset = m_size * 3;
+        std::memcpy( m_coords + offset, coords, sizeof( kvs::Real32 ) * n * 3 );
+        std::memcpy( m_normals + offset, normals, sizeof( kvs::Real32 ) * n * 3 );
+        std::memcpy( m_colors + offset, colors, sizeof( kvs::UInt8 ) * n * 3 );
+        m_size += n;
+    }
+    void push( const Particle& particle, const kvs::ColorMap& color_map )
+    {
+        KVS_ASSERT( m_size < m_capacity );
+        const kvs::RGBColor color = color_map.at( particle.scalar );
+        const size_t offset = m_size * 3;
+        m_coords[ offset + 0 ] = particle.coord.x();
+        m_coords[ offset + 1 ] = particle.coord.y();
+        m_coords[ offset + 2 ] = particle.coord.z();
+        m_normals[ offset + 0 ] = particle.normal.x();
+        m_normals[ offset + 1 ] = particle.normal.y();
+        m_normals[ offset + 2 ] = particle.normal.z();
+        m_colors[ offset + 0 ] = color.r();
+        m_colors[ offset + 1 ] = color.g();
+        m_colors[ offset + 2 ] = color.b();
+        m_size++;
+    }
+};
+
+/*===========================================================================*/
+/**
+ *  @brief  Output arrays preallocated from the numbers of particles of slices.
+ *
+ *  The slices are placed at the exclusive prefix sum of their capacities, so
+ *  they can be filled concurrently without locks. Since the sampling of a
+ *  cell may stop before generating all of its particles when no point with a
+ *  non-zero density is found, the unused slots are removed by compact().
+ */
+/*===========================================================================*/
+class ParticleBuffer
+{
+private:
+    kvs::ValueArray<kvs::Real32> m_coords; ///< coorinate value array
+    kvs::ValueArray<kvs::Real32> m_normals; ///< normal vector array
+    kvs::ValueArray<kvs::UInt8> m_colors; ///< color value array
+    std::vector<size_t> m_offsets; ///< offset (in particles) of each slice
+    std::vector<size_t> m_capacities; ///< capacity of each slice
+    std::vector<size_t> m_sizes; ///< number of particles written in each slice
+
+public:
+    const kvs::ValueArray<kvs::Real32>& coords() const { return m_coords; }
+    const kvs::ValueArray<kvs::Real32>& normals() const { return m_normals; }
+    const kvs::ValueArray<kvs::UInt8>& colors() const { return m_colors; }
+
+    void allocate( const std::vector<size_t>& capacities )
+    {
+        const size_t nslices = capacities.size();
+        m_capacities = capacities;
+        m_offsets.resize( nslices );
+        m_sizes.assign( nslices, 0 );
+
+        size_t total = 0;
+        for ( size_t index = 0; index < nslices; index++ )
+        {
+            m_offsets[index] = total;
+            total += capacities[index];
+        }
+
+        m_coords.allocate( total * 3 );
+        m_normals.allocate( total * 3 );
+        m_colors.allocate( total * 3 );
+    }
+
+    Particles slice( const size_t index )
+    {
+        const size_t offset = m_offsets[index] * 3;
+        return Particles(
+            m_coords.data() + offset,
+            m_normals.data() + offset,
+            m_colors.data() + offset,
+            m_capacities[index] );
+    }
+
+    const std::vector<size_t>& sizes() const { return m_sizes; }
+
+    void setSize( const size_t index, const size_t size )
+    {
+        m_sizes[index] = size;
+    }
+
+    void compact()
+    {
+        // Slices are moved toward the front in order, so the destination never
+        // overlaps the following slices.
+        size_t total = 0;
+        for ( size_t index = 0; index < m_sizes.size(); index++ )
+        {
+            const size_t size = m_sizes[index] * 3;
+            const size_t src = m_offsets[index] * 3;
+            const size_t dst = total * 3;
+            if ( src != dst && size > 0 )
+            {
+                std::memmove( m_coords.data() + dst, m_coords.data() + src, sizeof( kvs::Real32 ) * size );
+                std::memmove( m_normals.data() + dst, m_normals.data() + src, sizeof( kvs::Real32 ) * size );
+                std::memmove( m_colors.data() + dst, m_colors.data() + src, sizeof( kvs::UInt8 ) * size );
+            }
+            total += m_sizes[index];
+        }
+
+        const size_t capacity = m_coords.size() / 3;
+        const size_t nunused = capacity - total;
+        if ( nunused == 0 ) { return; }
+
+        // Trimming the arrays needs a copy of the whole output, so a few unused
+        // slots are filled with the copies of particles spread over the output
+        // instead, which changes the particle density negligibly.
+        if ( total > 0 && nunused <= total / 64 )
+        {
+            const size_t stride = total / nunused;
+            for ( size_t i = 0; i < nunused; i++ )
+            {
+                const size_t src = i * stride * 3;
+                const size_t dst = ( total + i ) * 3;
+                std::memcpy( m_coords.data() + dst, m_coords.data() + src, sizeof( kvs::Real32 ) * 3 );
+                std::memcpy( m_normals.data() + dst, m_normals.data() + src, sizeof( kvs::Real32 ) * 3 );
+                std::memcpy( m_colors.data() + dst, m_colors.data() + src, sizeof( kvs::UInt8 ) * 3 );
+            }
+            return;
+        }
+
+        // The arrays are trimmed one by one to keep the peak memory low.
+        m_coords = kvs::ValueArray<kvs::Real32>( m_coords.data(), total * 3 );
+        m_normals = kvs::ValueArray<kvs::Real32>( m_normals.data(), total * 3 );
+        m_colors = kvs::ValueArray<kvs::UInt8>( m_colors.data(), total * 3 );
+    }
+};
+
+} // end of namespace Internal
+
+} // end of namespace YYZVis
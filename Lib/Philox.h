@@ -0,0 +1,107 @@
+#pragma once
+#include <kvs/Type>
+
+
+namespace YYZVis
+{
+
+/*===========================================================================*/
+/**
+ *  @brief  Counter-based random number generator (Philox4x32-10).
+ *
+ *  The numbers are obtained by encrypting the counter (stream, index, draw)
+ *  with the seed as the key, so a sequence is determined only by the seed,
+ *  the stream and the index given to setCounter() (e.g. the cell index), and
+ *  does not depend on the order of the calls or the number of threads.
+ */
+/*===========================================================================*/
+class Philox
+{
+private:
+    kvs::UInt32 m_key[2]; ///< key (seed)
+    kvs::UInt32 m_counter[4]; ///< counter (draw block, stream, index low, index high)
+    kvs::UInt32 m_block[4]; ///< current block of random numbers
+    size_t m_position; ///< position of the next number in the block
+
+public:
+    Philox( const kvs::UInt32 seed = 0 )
+    {
+        this->setSeed( seed );
+    }
+
+    void setSeed( const kvs::UInt32 seed )
+    {
+        m_key[0] = seed;
+        m_key[1] = 0x5851F42Du;
+        this->setCounter( 0, 0 );
+    }
+
+    void setCounter( const kvs::UInt32 stream, const size_t index )
+    {
+        m_counter[0] = 0;
+        m_counter[1] = stream;
+        m_counter[2] = kvs::UInt32( index );
+        m_counter[3] = kvs::UInt32( static_cast<unsigned long long>( index ) >> 32 );
+        m_position = 4;
+    }
+
+    kvs::UInt32 randInteger()
+    {
+        if ( m_position == 4 )
+        {
+            this->generate();
+            m_counter[0]++;
+            m_position = 0;
+        }
+        return m_block[ m_position++ ];
+    }
+
+    kvs::Real32 rand()
+    {
+        // 24 bits fit in the mantissa, so the value is in [0,1).
+        return ( this->randInteger() >> 8 ) * ( 1.0f / 16777216.0f );
+    }
+
+    kvs::Real32 operator ()()
+    {
+        return this->rand();
+    }
+
+private:
+    void generate()
+    {
+        const kvs::UInt32 M0 = 0xD2511F53u;
+        const kvs::UInt32 M1 = 0xCD9E8D57u;
+        const kvs::UInt32 W0 = 0x9E3779B9u;
+        const kvs::UInt32 W1 = 0xBB67AE85u;
+
+        kvs::UInt32 c0 = m_counter[0];
+        kvs::UInt32 c1 = m_counter[1];
+        kvs::UInt32 c2 = m_counter[2];
+        kvs::UInt32 c3 = m_counter[3];
+        kvs::UInt32 k0 = m_key[0];
+        kvs::UInt32 k1 = m_key[1];
+        for ( int round = 0; round < 10; round++ )
+        {
+            const unsigned long long p0 = static_cast<unsigned long long>( M0 ) * c0;
+            const unsigned long long p1 = static_cast<unsigned long long>( M1 ) * c2;
+            const kvs::UInt32 hi0 = kvs::UInt32( p0 >> 32 );
+            const kvs::UInt32 lo0 = kvs::UInt32( p0 );
+            const kvs::UInt32 hi1 = kvs::UInt32( p1 >> 32 );
+            const kvs::UInt32 lo1 = kvs::UInt32( p1 );
+            c0 = hi1 ^ c1 ^ k0;
+            c1 = lo1;
+            c2 = hi0 ^ c3 ^ k1;
+            c3 = lo0;
+            k0 += W0;
+            k1 += W1;
+        }
+
+        m_block[0] = c0;
+        m_block[1] = c1;
+        m_block[2] = c2;
+        m_block[3] = c3;
+    }
+};
+
+} // end of namespace YYZVis
@@ -1,19 +1,49 @@
 #include "SlicePlane.h"
+#include "ValueType.h"
 #include <kvs/MarchingHexahedraTable>
 
 
 namespace
 {
 
-bool HasIgnoreValue( const kvs::AnyValueArray values, const size_t* indices, const double ignore_value = 0.0 )
+template <typename ValueType>
+bool HasIgnoreValue( const ValueType* values, const size_t* indices, const double ignore_value = 0.0 )
 {
     for ( size_t i = 0; i < 8; ++i )
     {
-        if ( kvs::Math::Equal( values.at<double>( indices[i] ), ignore_value ) ) { return true; }
+        if ( kvs::Math::Equal( double( values[ indices[i] ] ), ignore_value ) ) { return true; }
     }
     return false;
 }
 
+/*===========================================================================*/
+/**
+ *  @brief  Calculates coordinates of the eight nodes of the cell.
+ *  @param  volume [in] pointer to the yin/yang or zhong volume object
+ *  @param  i [in] base node index along the first axis
+ *  @param  j [in] base node index along the second axis
+ *  @param  k [in] base node index along the third axis
+ *  @param  coords [out] coordinates in the order of the local node index
+ */
+/*===========================================================================*/
+template <typename VolumeObject>
+inline void CellCoords(
+    const VolumeObject* volume,
+    const size_t i,
+    const size_t j,
+    const size_t k,
+    kvs::Vec3* coords )
+{
+    coords[0] = volume->coord( i,     j + 1, k     );
+    coords[1] = volume->coord( i + 1, j + 1, k     );
+    coords[2] = volume->coord( i + 1, j + 1, k + 1 );
+    coords[3] = volume->coord( i,     j + 1, k + 1 );
+    coords[4] = volume->coord( i,     j,     k     );
+    coords[5] = volume->coord( i + 1, j,     k     );
+    coords[6] = volume->coord( i + 1, j,     k + 1 );
+    coords[7] = volume->coord( i,     j,     k + 1 );
+}
+
 } // end of namespace
 
 
@@ -108,37 +138,53 @@ SlicePlane::SuperClass* SlicePlane::exec( const kvs::ObjectBase* object )
 
 void SlicePlane::mapping( const YYZVis::ZhongVolumeObject* zvolume )
 {
-    // std::vector<kvs::Real32> coords;
-    // std::vector<kvs::Real32> normals;
-    // std::vector<kvs::UInt8> colors;
-    // const kvs::ColorMap cmap = BaseClass::colorMap();
-
     // Calculate coords, normals and colors.
-     this->extract_plane( zvolume );
-
-    // SuperClass::setCoords( coords );
-    // SuperClass::setColors( colors );
-    // SuperClass::setNormals( normals );
-    // SuperClass::setOpacity( 255 );
+    this->extract_plane( zvolume, zvolume->values() );
 }
 
 void SlicePlane::mapping( const YYZVis::YinYangVolumeObjectBase* yvolume )
 {
-    // std::vector<kvs::Real32> coords;
-    // std::vector<kvs::Real32> normals;
-    // std::vector<kvs::UInt8> colors;
-    // const kvs::ColorMap cmap = BaseClass::colorMap();
-
     // Calculate coords, normals and colors.
-     this->extract_plane( yvolume );
+    this->extract_plane( yvolume, yvolume->values() );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Function object extracting the plane from the typed node values.
+ */
+/*===========================================================================*/
+template <typename VolumeObject>
+struct SlicePlane::PlaneExtractor
+{
+    SlicePlane* mapper; ///< pointer to the mapper
+    const VolumeObject* volume; ///< pointer to the volume object
 
-    // SuperClass::setCoords( coords );
-    // SuperClass::setColors( colors );
-    // SuperClass::setNormals( normals );
-    // SuperClass::setOpacity( 255 );
+    template <typename ValueType>
+    void operator ()( const ValueType* values ) const
+    {
+        mapper->extract_plane( volume, values );
+    }
+};
+
+/*===========================================================================*/
+/**
+ *  @brief  Extracts the plane for the value type of the volume.
+ *  @param  volume [in] pointer to yin/yang or zhong volume object
+ *  @param  values [in] node values of the volume
+ *
+ *  The value type is dispatched once here, so the node values are read from
+ *  the typed array in the loops over the cells.
+ */
+/*===========================================================================*/
+template <typename VolumeObject>
+void SlicePlane::extract_plane( const VolumeObject* volume, const kvs::AnyValueArray& values )
+{
+    const PlaneExtractor<VolumeObject> extractor = { this, volume };
+    if ( !YYZVis::DispatchValueType( values, extractor ) ) { BaseClass::setSuccess( false ); }
 }
 
-void SlicePlane::extract_plane( const YYZVis::YinYangVolumeObjectBase* yvolume )
+template <typename ValueType>
+void SlicePlane::extract_plane( const YYZVis::YinYangVolumeObjectBase* yvolume, const ValueType* values )
 {
    // Calculated the coordinate data array and the normal vector array.
     std::vector<kvs::Real32> coords;
@@ -155,8 +201,6 @@ void SlicePlane::extract_plane( const YYZVis::YinYangVolumeObjectBase* yvolume )
     const size_t line_size = dim_r;
     const size_t slice_size = dim_r * dim_theta;
 
-    const kvs::Real32* yvolume_coords = yvolume->coords().data();
-
     const kvs::ColorMap& color_map( BaseClass::transferFunction().colorMap() );
 
     // Extract surfaces.
@@ -178,8 +222,12 @@ void SlicePlane::extract_plane( const YYZVis::YinYangVolumeObjectBase* yvolume )
                 local_index[6] = index + slice_size + 1;
                 local_index[7] = index + slice_size;
 
+                // Calculate the node coordinates of the target cell.
+                kvs::Vec3 cell_coords[8];
+                ::CellCoords( yvolume, i, j, k, cell_coords );
+
                 // Calculate the index of the reference table.
-                const size_t table_index = this->calculate_hexahedra_table_index( local_index );
+                const size_t table_index = this->calculate_hexahedra_table_index( cell_coords );
                 if ( table_index == 0 ) continue;
                 if ( table_index == 255 ) continue;
 
@@ -191,23 +239,23 @@ void SlicePlane::extract_plane( const YYZVis::YinYangVolumeObjectBase* yvolume )
                     const int e1 = kvs::MarchingHexahedraTable::TriangleID[table_index][t+1];
                     const int e2 = kvs::MarchingHexahedraTable::TriangleID[table_index][t+2];
 
-                    // Refer indices of the coordinate array from the VertexTable using the edgeIDs.
-                    const size_t c0 = local_index[ kvs::MarchingHexahedraTable::VertexID[e0][0] ];
-                    const size_t c1 = local_index[ kvs::MarchingHexahedraTable::VertexID[e0][1] ];
-                    const size_t c2 = local_index[ kvs::MarchingHexahedraTable::VertexID[e1][0] ];
-                    const size_t c3 = local_index[ kvs::MarchingHexahedraTable::VertexID[e1][1] ];
-                    const size_t c4 = local_index[ kvs::MarchingHexahedraTable::VertexID[e2][0] ];
-                    const size_t c5 = local_index[ kvs::MarchingHexahedraTable::VertexID[e2][1] ];
+                    // Refer local node indices from the VertexTable using the edgeIDs.
+                    const int l0 = kvs::MarchingHexahedraTable::VertexID[e0][0];
+                    const int l1 = kvs::MarchingHexahedraTable::VertexID[e0][1];
+                    const int l2 = kvs::MarchingHexahedraTable::VertexID[e1][0];
+                    const int l3 = kvs::MarchingHexahedraTable::VertexID[e1][1];
+                    const int l4 = kvs::MarchingHexahedraTable::VertexID[e2][0];
+                    const int l5 = kvs::MarchingHexahedraTable::VertexID[e2][1];
 
                     // Determine vertices for each edge.
-                    const kvs::Vec3 v0( yvolume_coords + 3 * c0 );
-                    const kvs::Vec3 v1( yvolume_coords + 3 * c1 );
+                    const kvs::Vec3& v0 = cell_coords[l0];
+                    const kvs::Vec3& v1 = cell_coords[l1];
 
-                    const kvs::Vec3 v2( yvolume_coords + 3 * c2 );
-                    const kvs::Vec3 v3( yvolume_coords + 3 * c3 );
+                    const kvs::Vec3& v2 = cell_coords[l2];
+                    const kvs::Vec3& v3 = cell_coords[l3];
 
-                    const kvs::Vec3 v4( yvolume_coords + 3 * c4 );
-                    const kvs::Vec3 v5( yvolume_coords + 3 * c5 );
+                    const kvs::Vec3& v4 = cell_coords[l4];
+                    const kvs::Vec3& v5 = cell_coords[l5];
 
                     // Calculate coordinates of the vertices which are composed
                     // of the triangle polygon.
@@ -226,9 +274,9 @@ void SlicePlane::extract_plane( const YYZVis::YinYangVolumeObjectBase* yvolume )
                     coords.push_back( vertex2.y() );
                     coords.push_back( vertex2.z() );
 
-                    const double value0 = this->interpolate_value( yvolume, c0, c1 );
-                    const double value1 = this->interpolate_value( yvolume, c2, c3 );
-                    const double value2 = this->interpolate_value( yvolume, c4, c5 );
+                    const double value0 = this->interpolate_value( values, v0, v1, local_index[l0], local_index[l1] );
+                    const double value1 = this->interpolate_value( values, v2, v3, local_index[l2], local_index[l3] );
+                    const double value2 = this->interpolate_value( values, v4, v5, local_index[l4], local_index[l5] );
 
                     const kvs::UInt8 color0 =
                         static_cast<kvs::UInt8>( normalize_factor * ( value0 - min_value ) );
@@ -267,7 +315,8 @@ void SlicePlane::extract_plane( const YYZVis::YinYangVolumeObjectBase* yvolume )
     SuperClass::setNormalType( kvs::PolygonObject::PolygonNormal );
 }
 
-void SlicePlane::extract_plane( const YYZVis::ZhongVolumeObject* zvolume )
+template <typename ValueType>
+void SlicePlane::extract_plane( const YYZVis::ZhongVolumeObject* zvolume, const ValueType* values )
 {
     // Calculated the coordinate data array and the normal vector array.
     std::vector<kvs::Real32> coords;
@@ -282,8 +331,6 @@ void SlicePlane::extract_plane( const YYZVis::ZhongVolumeObject* zvolume )
     const size_t line_size = dim;
     const size_t slice_size = dim * dim;
 
-    const kvs::Real32* zvolume_coords = zvolume->coords().data();
-
     const kvs::ColorMap& color_map( BaseClass::transferFunction().colorMap() );
 
     // Extract surfaces.
@@ -305,10 +352,14 @@ void SlicePlane::extract_plane( const YYZVis::ZhongVolumeObject* zvolume )
                 local_index[6] = index + slice_size + 1;
                 local_index[7] = index + slice_size;
 
-                if ( ::HasIgnoreValue( zvolume->values(), local_index, 0.0 ) ) { continue; }
+                if ( ::HasIgnoreValue( values, local_index, 0.0 ) ) { continue; }
+
+                // Calculate the node coordinates of the target cell.
+                kvs::Vec3 cell_coords[8];
+                ::CellCoords( zvolume, i, j, k, cell_coords );
 
                 // Calculate the index of the reference table.
-                const size_t table_index = this->calculate_hexahedra_table_index( local_index );
+                const size_t table_index = this->calculate_hexahedra_table_index( cell_coords );
                 if ( table_index == 0 ) continue;
                 if ( table_index == 255 ) continue;
 
@@ -320,23 +371,23 @@ void SlicePlane::extract_plane( const YYZVis::ZhongVolumeObject* zvolume )
                     const int e1 = kvs::MarchingHexahedraTable::TriangleID[table_index][t+1];
                     const int e2 = kvs::MarchingHexahedraTable::TriangleID[table_index][t+2];
 
-                    // Refer indices of the coordinate array from the VertexTable using the edgeIDs.
-                    const size_t c0 = local_index[ kvs::MarchingHexahedraTable::VertexID[e0][0] ];
-                    const size_t c1 = local_index[ kvs::MarchingHexahedraTable::VertexID[e0][1] ];
-                    const size_t c2 = local_index[ kvs::MarchingHexahedraTable::VertexID[e1][0] ];
-                    const size_t c3 = local_index[ kvs::MarchingHexahedraTable::VertexID[e1][1] ];
-                    const size_t c4 = local_index[ kvs::MarchingHexahedraTable::VertexID[e2][0] ];
-                    const size_t c5 = local_index[ kvs::MarchingHexahedraTable::VertexID[e2][1] ];
+                    // Refer local node indices from the VertexTable using the edgeIDs.
+                    const int l0 = kvs::MarchingHexahedraTable::VertexID[e0][0];
+                    const int l1 = kvs::MarchingHexahedraTable::VertexID[e0][1];
+                    const int l2 = kvs::MarchingHexahedraTable::VertexID[e1][0];
+                    const int l3 = kvs::MarchingHexahedraTable::VertexID[e1][1];
+                    const int l4 = kvs::MarchingHexahedraTable::VertexID[e2][0];
+                    const int l5 = kvs::MarchingHexahedraTable::VertexID[e2][1];
 
                     // Determine vertices for each edge.
-                    const kvs::Vec3 v0( zvolume_coords + 3 * c0 );
-                    const kvs::Vec3 v1( zvolume_coords + 3 * c1 );
+                    const kvs::Vec3& v0 = cell_coords[l0];
+                    const kvs::Vec3& v1 = cell_coords[l1];
 
-                    const kvs::Vec3 v2( zvolume_coords + 3 * c2 );
-                    const kvs::Vec3 v3( zvolume_coords + 3 * c3 );
+                    const kvs::Vec3& v2 = cell_coords[l2];
+                    const kvs::Vec3& v3 = cell_coords[l3];
 
-                    const kvs::Vec3 v4( zvolume_coords + 3 * c4 );
-                    const kvs::Vec3 v5( zvolume_coords + 3 * c5 );
+                    const kvs::Vec3& v4 = cell_coords[l4];
+                    const kvs::Vec3& v5 = cell_coords[l5];
 
                     // Calculate coordinates of the vertices which are composed
                     // of the triangle polygon.
@@ -355,9 +406,9 @@ void SlicePlane::extract_plane( const YYZVis::ZhongVolumeObject* zvolume )
                     coords.push_back( vertex2.y() );
                     coords.push_back( vertex2.z() );
 
-                    const double value0 = this->interpolate_value( zvolume, c0, c1 );
-                    const double value1 = this->interpolate_value( zvolume, c2, c3 );
-                    const double value2 = this->interpolate_value( zvolume, c4, c5 );
+                    const double value0 = this->interpolate_value( values, v0, v1, local_index[l0], local_index[l1] );
+                    const double value1 = this->interpolate_value( values, v2, v3, local_index[l2], local_index[l3] );
+                    const double value2 = this->interpolate_value( values, v4, v5, local_index[l4], local_index[l5] );
 
                     const kvs::UInt8 color0 =
                         static_cast<kvs::UInt8>( normalize_factor * ( value0 - min_value ) );
@@ -396,28 +447,17 @@ void SlicePlane::extract_plane( const YYZVis::ZhongVolumeObject* zvolume )
     SuperClass::setNormalType( kvs::PolygonObject::PolygonNormal );
 }
 
-size_t SlicePlane::calculate_hexahedra_table_index( const size_t* local_index ) const
+size_t SlicePlane::calculate_hexahedra_table_index( const kvs::Vec3* vertices ) const
 {
-    const kvs::Real32* const coords = BaseClass::volume()->coords().data();
-
-    const kvs::Vec3 vertex0( coords + 3 * local_index[0] );
-    const kvs::Vec3 vertex1( coords + 3 * local_index[1] );
-    const kvs::Vec3 vertex2( coords + 3 * local_index[2] );
-    const kvs::Vec3 vertex3( coords + 3 * local_index[3] );
-    const kvs::Vec3 vertex4( coords + 3 * local_index[4] );
-    const kvs::Vec3 vertex5( coords + 3 * local_index[5] );
-    const kvs::Vec3 vertex6( coords + 3 * local_index[6] );
-    const kvs::Vec3 vertex7( coords + 3 * local_index[7] );
-
     size_t table_index = 0;
-    if ( this->substitute_plane_equation( vertex0 ) > 0.0 ) { table_index |=   1; }
-    if ( this->substitute_plane_equation( vertex1 ) > 0.0 ) { table_index |=   2; }
-    if ( this->substitute_plane_equation( vertex2 ) > 0.0 ) { table_index |=   4; }
-    if ( this->substitute_plane_equation( vertex3 ) > 0.0 ) { table_index |=   8; }
-    if ( this->substitute_plane_equation( vertex4 ) > 0.0 ) { table_index |=  16; }
-    if ( this->substitute_plane_equation( vertex5 ) > 0.0 ) { table_index |=  32; }
-    if ( this->substitute_plane_equation( vertex6 ) > 0.0 ) { table_index |=  64; }
-    if ( this->substitute_plane_equation( vertex7 ) > 0.0 ) { table_index |= 128; }
+    if ( this->substitute_plane_equation( vertices[0] ) > 0.0 ) { table_index |=   1; }
+    if ( this->substitute_plane_equation( vertices[1] ) > 0.0 ) { table_index |=   2; }
+    if ( this->substitute_plane_equation( vertices[2] ) > 0.0 ) { table_index |=   4; }
+    if ( this->substitute_plane_equation( vertices[3] ) > 0.0 ) { table_index |=   8; }
+    if ( this->substitute_plane_equation( vertices[4] ) > 0.0 ) { table_index |=  16; }
+    if ( this->substitute_plane_equation( vertices[5] ) > 0.0 ) { table_index |=  32; }
+    if ( this->substitute_plane_equation( vertices[6] ) > 0.0 ) { table_index |=  64; }
+    if ( this->substitute_plane_equation( vertices[7] ) > 0.0 ) { table_index |= 128; }
 
     return table_index;
 }
@@ -442,34 +482,21 @@ const kvs::Vec3 SlicePlane::interpolate_vertex(
     return ( 1.0f - ratio ) * vertex0 + ratio * vertex1;
 }
 
+template <typename ValueType>
 double SlicePlane::interpolate_value(
-    const YYZVis::YinYangVolumeObjectBase* yvolume,
-    const size_t index0,
-    const size_t index1 ) const
-{
-    const kvs::AnyValueArray values = yvolume->values();
-    const kvs::Real32* const coords = yvolume->coords().data();
-
-    const float value0 = this->substitute_plane_equation( kvs::Vec3( coords + 3 * index0 ) );
-    const float value1 = this->substitute_plane_equation( kvs::Vec3( coords + 3 * index1 ) );
-    const float ratio = kvs::Math::Abs( value0 / ( value1 - value0 ) );
-
-    return values.at<float>( index0 ) + ratio * ( values.at<float>( index1 ) - values.at<float>( index0 ) );
-}
-
-double SlicePlane::interpolate_value(
-    const YYZVis::ZhongVolumeObject* zvolume,
+    const ValueType* values,
+    const kvs::Vec3& vertex0,
+    const kvs::Vec3& vertex1,
     const size_t index0,
     const size_t index1 ) const
 {
-    const kvs::AnyValueArray values = zvolume->values();
-    const kvs::Real32* const coords = zvolume->coords().data();
-
-    const float value0 = this->substitute_plane_equation( kvs::Vec3( coords + 3 * index0 ) );
-    const float value1 = this->substitute_plane_equation( kvs::Vec3( coords + 3 * index1 ) );
+    const float value0 = this->substitute_plane_equation( vertex0 );
+    const float value1 = this->substitute_plane_equation( vertex1 );
     const float ratio = kvs::Math::Abs( value0 / ( value1 - value0 ) );
 
-    return values.at<float>( index0 ) + ratio * ( values.at<float>( index1 ) - values.at<float>( index0 ) );
+    const double s0 = double( values[index0] );
+    const double s1 = double( values[index1] );
+    return s0 + ratio * ( s1 - s0 );
 }
 
 } // end of namespace YYZVis
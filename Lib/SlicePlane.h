@@ -39,15 +39,21 @@ public:
     SuperClass* exec( const kvs::ObjectBase* object );
 
 private:
+    template <typename VolumeObject> struct PlaneExtractor;
+
     void mapping( const YYZVis::ZhongVolumeObject* zvolume );
     void mapping( const YYZVis::YinYangVolumeObjectBase* yvolume );
-    void extract_plane( const YYZVis::YinYangVolumeObjectBase* yvolume );
-    void extract_plane( const YYZVis::ZhongVolumeObject* zvolume );
-    size_t calculate_hexahedra_table_index( const size_t* local_index ) const;
+    template <typename VolumeObject>
+    void extract_plane( const VolumeObject* volume, const kvs::AnyValueArray& values );
+    template <typename ValueType>
+    void extract_plane( const YYZVis::YinYangVolumeObjectBase* yvolume, const ValueType* values );
+    template <typename ValueType>
+    void extract_plane( const YYZVis::ZhongVolumeObject* zvolume, const ValueType* values );
+    size_t calculate_hexahedra_table_index( const kvs::Vec3* vertices ) const;
     float substitute_plane_equation( const kvs::Vec3& vertex ) const;
     const kvs::Vec3 interpolate_vertex( const kvs::Vec3& vertex0, const kvs::Vec3& vertex1 ) const;
-    double interpolate_value( const YYZVis::YinYangVolumeObjectBase* yvolume, const size_t index0, const size_t index1 ) const;
-    double interpolate_value( const YYZVis::ZhongVolumeObject* zvolume, const size_t index0, const size_t index1 ) const;
+    template <typename ValueType>
+    double interpolate_value( const ValueType* values, const kvs::Vec3& vertex0, const kvs::Vec3& vertex1, const size_t index0, const size_t index1 ) const;
 };
 
 } // end of namespace YYZVis
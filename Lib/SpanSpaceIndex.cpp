@@ -0,0 +1,284 @@
+#include "SpanSpaceIndex.h"
+#include "Parallel.h"
+#include "ValueType.h"
+#include <kvs/Math>
+#include <kvs/Message>
+#include <algorithm>
+#include <limits>
+
+
+namespace
+{
+
+template <typename ValueType>
+inline void CalculateMinMax(
+    const ValueType* values,
+    const kvs::Vec3ui& resolution,
+    kvs::Real32* min_values,
+    kvs::Real32* max_values )
+{
+    const size_t dim0 = resolution[0];
+    const size_t dim1 = resolution[0] * resolution[1];
+    const size_t ncells0 = resolution[0] - 1;
+    const size_t ncells1 = resolution[1] - 1;
+    YYZVis::Parallel::For( 0, resolution[2] - 1, [&]( const size_t k )
+    {
+        for ( size_t j = 0; j < ncells1; j++ )
+        {
+            const ValueType* p0 = values + dim0 * j + dim1 * k;
+            const ValueType* p1 = p0 + dim0;
+            const ValueType* p2 = p0 + dim1;
+            const ValueType* p3 = p1 + dim1;
+            size_t index = ncells0 * ( j + ncells1 * k );
+            for ( size_t i = 0; i < ncells0; i++, index++ )
+            {
+                ValueType min_value = p0[i];
+                ValueType max_value = p0[i];
+                min_value = kvs::Math::Min( min_value, p0[i+1] ); max_value = kvs::Math::Max( max_value, p0[i+1] );
+                min_value = kvs::Math::Min( min_value, p1[i] );   max_value = kvs::Math::Max( max_value, p1[i] );
+                min_value = kvs::Math::Min( min_value, p1[i+1] ); max_value = kvs::Math::Max( max_value, p1[i+1] );
+                min_value = kvs::Math::Min( min_value, p2[i] );   max_value = kvs::Math::Max( max_value, p2[i] );
+                min_value = kvs::Math::Min( min_value, p2[i+1] ); max_value = kvs::Math::Max( max_value, p2[i+1] );
+                min_value = kvs::Math::Min( min_value, p3[i] );   max_value = kvs::Math::Max( max_value, p3[i] );
+                min_value = kvs::Math::Min( min_value, p3[i+1] ); max_value = kvs::Math::Max( max_value, p3[i+1] );
+                min_values[index] = YYZVis::RoundToReal32( min_value, -std::numeric_limits<kvs::Real32>::infinity() );
+                max_values[index] = YYZVis::RoundToReal32( max_value, std::numeric_limits<kvs::Real32>::infinity() );
+            }
+        }
+    } );
+}
+
+struct MinMaxCalculator
+{
+    kvs::Vec3ui resolution; ///< number of nodes along each axis
+    kvs::Real32* min_values; ///< min. values of the cells
+    kvs::Real32* max_values; ///< max. values of the cells
+
+    template <typename ValueType>
+    void operator ()( const ValueType* values ) const
+    {
+        ::CalculateMinMax( values, resolution, min_values, max_values );
+    }
+};
+
+} // end of namespace
+
+
+namespace YYZVis
+{
+
+SpanSpaceIndex::SpanSpaceIndex():
+    m_dims( 0, 0, 0 ),
+    m_values_data( NULL ),
+    m_nvalues( 0 ),
+    m_values_type( kvs::Type::UnknownType )
+{
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Checks whether the index is created for the node values.
+ *  @param  values [in] current node values of the volume
+ *  @param  resolution [in] number of nodes along each axis
+ *  @return true if the index can be used for the grid
+ *
+ *  The values must be the array the index was created from, since the volume
+ *  cannot notify the replacement of its values.
+ */
+/*===========================================================================*/
+bool SpanSpaceIndex::isValid( const kvs::AnyValueArray& values, const kvs::Vec3ui& resolution ) const
+{
+    if ( this->isEmpty() ) { return false; }
+    return
+        m_values_data == values.data() &&
+        m_nvalues == values.size() &&
+        m_values_type == values.typeID() &&
+        m_dims[0] + 1 == resolution[0] &&
+        m_dims[1] + 1 == resolution[1] &&
+        m_dims[2] + 1 == resolution[2];
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns the cells intersected by the isosurface.
+ *  @param  isolevel [in] isosurface level
+ *  @param  cells [out] cell indices in ascending order
+ */
+/*===========================================================================*/
+void SpanSpaceIndex::activeCells( const double isolevel, std::vector<kvs::UInt32>* cells ) const
+{
+    cells->clear();
+    this->append_active_cells( isolevel, cells );
+    std::sort( cells->begin(), cells->end() );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns the cells intersected by at least one of the isosurfaces.
+ *  @param  isolevels [in] isosurface levels
+ *  @param  cells [out] cell indices in ascending order
+ */
+/*===========================================================================*/
+void SpanSpaceIndex::activeCells( const std::vector<double>& isolevels, std::vector<kvs::UInt32>* cells ) const
+{
+    cells->clear();
+    for ( size_t level = 0; level < isolevels.size(); level++ )
+    {
+        this->append_active_cells( isolevels[level], cells );
+    }
+    std::sort( cells->begin(), cells->end() );
+    if ( isolevels.size() > 1 )
+    {
+        cells->erase( std::unique( cells->begin(), cells->end() ), cells->end() );
+    }
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Creates the span space index.
+ *  @param  values [in] node values (scalar)
+ *  @param  resolution [in] number of nodes along each axis
+ *  @param  nbuckets [in] number of buckets of the min. values
+ *
+ *  The min/max values of the cells are rounded outward when they are
+ *  converted to Real32, so the active cells found by the index include all
+ *  of the cells intersected by the isosurface.
+ */
+/*===========================================================================*/
+void SpanSpaceIndex::create( const kvs::AnyValueArray& values, const kvs::Vec3ui& resolution, const size_t nbuckets )
+{
+    this->release();
+    if ( nbuckets == 0 || values.size() == 0 ) { return; }
+    if ( resolution[0] < 2 || resolution[1] < 2 || resolution[2] < 2 ) { return; }
+    if ( values.size() != size_t( resolution[0] ) * resolution[1] * resolution[2] )
+    {
+        kvsMessageError() << "The span space index is available only for the scalar volume." << std::endl;
+        return;
+    }
+
+    // Min/max values of the cells.
+    const kvs::Vec3ui dims = resolution - kvs::Vec3ui( 1, 1, 1 );
+    const size_t ncells = size_t( dims[0] ) * dims[1] * dims[2];
+    std::vector<kvs::Real32> cell_min_values( ncells );
+    std::vector<kvs::Real32> cell_max_values( ncells );
+    kvs::Real32* const min_values = cell_min_values.data();
+    kvs::Real32* const max_values = cell_max_values.data();
+    const ::MinMaxCalculator calculator = { resolution, min_values, max_values };
+    if ( !YYZVis::DispatchValueType( values, calculator ) ) { return; }
+
+    // Range of the min. values of the cells which can be intersected.
+    kvs::Real32 lower = std::numeric_limits<kvs::Real32>::max();
+    kvs::Real32 upper = -std::numeric_limits<kvs::Real32>::max();
+    for ( size_t index = 0; index < ncells; index++ )
+    {
+        if ( min_values[index] == max_values[index] ) { continue; }
+        lower = kvs::Math::Min( lower, min_values[index] );
+        upper = kvs::Math::Max( upper, min_values[index] );
+    }
+
+    // Bucket of each cell by the min. value.
+    const double scale = upper > lower ? double( nbuckets ) / ( double( upper ) - double( lower ) ) : 0.0;
+    auto bucket_index = [&]( const kvs::Real32 min_value )
+    {
+        const size_t b = static_cast<size_t>( ( double( min_value ) - double( lower ) ) * scale );
+        return kvs::Math::Min( b, nbuckets - 1 );
+    };
+
+    std::vector<kvs::UInt32> offsets( nbuckets + 1, 0 );
+    for ( size_t index = 0; index < ncells; index++ )
+    {
+        if ( min_values[index] == max_values[index] ) { continue; }
+        offsets[ bucket_index( min_values[index] ) + 1 ]++;
+    }
+    for ( size_t b = 0; b < nbuckets; b++ ) { offsets[ b + 1 ] += offsets[b]; }
+
+    m_cells.allocate( offsets.back() );
+    std::vector<kvs::UInt32> positions( offsets.begin(), offsets.end() - 1 );
+    for ( size_t index = 0; index < ncells; index++ )
+    {
+        if ( min_values[index] == max_values[index] ) { continue; }
+        m_cells[ positions[ bucket_index( min_values[index] ) ]++ ] = kvs::UInt32( index );
+    }
+
+    // Sort the cells in each bucket in descending order of the max. values.
+    m_offsets.allocate( nbuckets + 1 );
+    m_bucket_min_values.allocate( nbuckets );
+    m_bucket_max_values.allocate( nbuckets );
+    m_min_values.allocate( m_cells.size() );
+    m_max_values.allocate( m_cells.size() );
+    std::copy( offsets.begin(), offsets.end(), m_offsets.data() );
+    kvs::UInt32* const cells = m_cells.data();
+    YYZVis::Parallel::For( 0, nbuckets, [&]( const size_t b )
+    {
+        kvs::UInt32* const first = cells + offsets[b];
+        kvs::UInt32* const last = cells + offsets[ b + 1 ];
+        std::sort( first, last, [&]( const kvs::UInt32 a, const kvs::UInt32 c )
+        {
+            return max_values[a] > max_values[c] || ( max_values[a] == max_values[c] && a < c );
+        } );
+
+        kvs::Real32 bucket_min = std::numeric_limits<kvs::Real32>::max();
+        kvs::Real32 bucket_max = -std::numeric_limits<kvs::Real32>::max();
+        for ( size_t m = offsets[b]; m < offsets[ b + 1 ]; m++ )
+        {
+            m_min_values[m] = min_values[ cells[m] ];
+            m_max_values[m] = max_values[ cells[m] ];
+            bucket_min = kvs::Math::Min( bucket_min, m_min_values[m] );
+            bucket_max = kvs::Math::Max( bucket_max, m_min_values[m] );
+        }
+        m_bucket_min_values[b] = bucket_min;
+        m_bucket_max_values[b] = bucket_max;
+    } );
+
+    m_dims = dims;
+    m_values_data = values.data();
+    m_nvalues = values.size();
+    m_values_type = values.typeID();
+}
+
+void SpanSpaceIndex::release()
+{
+    m_dims = kvs::Vec3ui( 0, 0, 0 );
+    m_values_data = NULL;
+    m_nvalues = 0;
+    m_values_type = kvs::Type::UnknownType;
+    m_offsets.release();
+    m_bucket_min_values.release();
+    m_bucket_max_values.release();
+    m_cells.release();
+    m_min_values.release();
+    m_max_values.release();
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Appends the cells intersected by the isosurface.
+ *  @param  isolevel [in] isosurface level
+ *  @param  cells [in/out] cell indices
+ *
+ *  Since the buckets are ordered by the min. values, the scan stops at the
+ *  first bucket whose min. values all exceed the isolevel. In each bucket, the
+ *  scan stops at the first cell whose max. value does not exceed the isolevel,
+ *  and the min. values are tested only in the bucket straddling the isolevel.
+ */
+/*===========================================================================*/
+void SpanSpaceIndex::append_active_cells( const double isolevel, std::vector<kvs::UInt32>* cells ) const
+{
+    const size_t nbuckets = this->numberOfBuckets();
+    for ( size_t b = 0; b < nbuckets; b++ )
+    {
+        const size_t first = m_offsets[b];
+        const size_t last = m_offsets[ b + 1 ];
+        if ( first == last ) { continue; }
+        if ( m_bucket_min_values[b] > isolevel ) { break; }
+
+        const bool straddle = m_bucket_max_values[b] > isolevel;
+        for ( size_t m = first; m < last && m_max_values[m] > isolevel; m++ )
+        {
+            if ( straddle && m_min_values[m] > isolevel ) { continue; }
+            cells->push_back( m_cells[m] );
+        }
+    }
+}
+
+} // end of namespace YYZVis
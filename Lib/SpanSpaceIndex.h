@@ -0,0 +1,76 @@
+#pragma once
+#include <vector>
+#include <kvs/Type>
+#include <kvs/Vector3>
+#include <kvs/ValueArray>
+#include <kvs/AnyValueArray>
+
+
+namespace YYZVis
+{
+
+/*===========================================================================*/
+/**
+ *  @brief  Span space index of the cells for the isosurface extraction.
+ *
+ *  Each cell is a point (min, max) in the span space, and the cell is
+ *  intersected by the isosurface if min <= isolevel < max. The cells are
+ *  divided into the buckets by the min. values, and sorted in descending order
+ *  of the max. values in each bucket, so the active cells for an isolevel are
+ *  found by scanning only the prefixes of the buckets whose min. values do
+ *  not exceed the isolevel. The cost is proportional to the number of the
+ *  active cells rather than that of the cells. The cells whose min. and max.
+ *  values are equal are never intersected and are not stored.
+ */
+/*===========================================================================*/
+class SpanSpaceIndex
+{
+public:
+    enum { DefaultNumberOfBuckets = 256 };
+
+private:
+    kvs::Vec3ui m_dims; ///< number of cells along each axis
+    kvs::ValueArray<kvs::UInt32> m_offsets; ///< offset of each bucket in the cells (nbuckets + 1)
+    kvs::ValueArray<kvs::Real32> m_bucket_min_values; ///< smallest min. value of the cells in each bucket
+    kvs::ValueArray<kvs::Real32> m_bucket_max_values; ///< largest min. value of the cells in each bucket
+    kvs::ValueArray<kvs::UInt32> m_cells; ///< cell indices sorted by the buckets and the max. values
+    kvs::ValueArray<kvs::Real32> m_min_values; ///< min. value of each cell in m_cells
+    kvs::ValueArray<kvs::Real32> m_max_values; ///< max. value of each cell in m_cells
+    const void* m_values_data; ///< node values used to create the index (reference)
+    size_t m_nvalues; ///< number of the node values
+    kvs::Type::TypeID m_values_type; ///< type of the node values
+
+public:
+    SpanSpaceIndex();
+
+    const kvs::Vec3ui& dims() const { return m_dims; }
+    size_t numberOfBuckets() const { return m_offsets.size() > 0 ? m_offsets.size() - 1 : 0; }
+    size_t numberOfCells() const { return m_cells.size(); }
+    bool isEmpty() const { return m_offsets.size() == 0; }
+
+    bool isValid( const kvs::AnyValueArray& values, const kvs::Vec3ui& resolution ) const;
+    size_t cellIndex( const size_t i, const size_t j, const size_t k ) const;
+    void activeCells( const double isolevel, std::vector<kvs::UInt32>* cells ) const;
+    void activeCells( const std::vector<double>& isolevels, std::vector<kvs::UInt32>* cells ) const;
+    void create( const kvs::AnyValueArray& values, const kvs::Vec3ui& resolution, const size_t nbuckets = DefaultNumberOfBuckets );
+    void release();
+
+private:
+    void append_active_cells( const double isolevel, std::vector<kvs::UInt32>* cells ) const;
+};
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns the index of the cell (i,j,k).
+ *  @param  i [in] base node index along the first axis
+ *  @param  j [in] base node index along the second axis
+ *  @param  k [in] base node index along the third axis
+ *  @return cell index
+ */
+/*===========================================================================*/
+inline size_t SpanSpaceIndex::cellIndex( const size_t i, const size_t j, const size_t k ) const
+{
+    return i + m_dims[0] * ( j + m_dims[1] * k );
+}
+
+} // end of namespace YYZVis
@@ -22,9 +22,9 @@ inline void UpdateMinMaxCoords(
     const kvs::Real32 min_x = kvs::Math::Min( min_coord0.x(), min_coord1.x(), min_coord2.x() );
     const kvs::Real32 min_y = kvs::Math::Min( min_coord0.y(), min_coord1.y(), min_coord2.y() );
     const kvs::Real32 min_z = kvs::Math::Min( min_coord0.z(), min_coord1.z(), min_coord2.z() );
-    const kvs::Real32 max_x = kvs::Math::Min( max_coord0.x(), max_coord1.x(), max_coord2.x() );
-    const kvs::Real32 max_y = kvs::Math::Min( max_coord0.y(), max_coord1.y(), max_coord2.y() );
-    const kvs::Real32 max_z = kvs::Math::Min( max_coord0.z(), max_coord1.z(), max_coord2.z() );
+    const kvs::Real32 max_x = kvs::Math::Max( max_coord0.x(), max_coord1.x(), max_coord2.x() );
+    const kvs::Real32 max_y = kvs::Math::Max( max_coord0.y(), max_coord1.y(), max_coord2.y() );
+    const kvs::Real32 max_z = kvs::Math::Max( max_coord0.z(), max_coord1.z(), max_coord2.z() );
     const kvs::Vec3 min_coord( min_x, min_y, min_z );
     const kvs::Vec3 max_coord( max_x, max_y, max_z );
     yin_volume->setMinMaxObjectCoords( min_coord, max_coord );
@@ -0,0 +1,64 @@
+#pragma once
+#include <kvs/AnyValueArray>
+#include <kvs/Type>
+#include <kvs/Message>
+#include <cmath>
+
+
+namespace YYZVis
+{
+
+/*===========================================================================*/
+/**
+ *  @brief  Calls the function object with the typed pointer to the values.
+ *  @param  values [in] values
+ *  @param  func [in] function object with operator()( const T* ) for the value types
+ *  @return false if the value type is not supported
+ *
+ *  The value type is dispatched once, so the function object can read the
+ *  values from the typed array in its loops.
+ */
+/*===========================================================================*/
+template <typename Function>
+inline bool DispatchValueType( const kvs::AnyValueArray& values, const Function& func )
+{
+    switch ( values.typeID() )
+    {
+    case kvs::Type::TypeInt8:   func( values.asValueArray<kvs::Int8>().data() ); return true;
+    case kvs::Type::TypeUInt8:  func( values.asValueArray<kvs::UInt8>().data() ); return true;
+    case kvs::Type::TypeInt16:  func( values.asValueArray<kvs::Int16>().data() ); return true;
+    case kvs::Type::TypeUInt16: func( values.asValueArray<kvs::UInt16>().data() ); return true;
+    case kvs::Type::TypeInt32:  func( values.asValueArray<kvs::Int32>().data() ); return true;
+    case kvs::Type::TypeUInt32: func( values.asValueArray<kvs::UInt32>().data() ); return true;
+    case kvs::Type::TypeInt64:  func( values.asValueArray<kvs::Int64>().data() ); return true;
+    case kvs::Type::TypeUInt64: func( values.asValueArray<kvs::UInt64>().data() ); return true;
+    case kvs::Type::TypeReal32: func( values.asValueArray<kvs::Real32>().data() ); return true;
+    case kvs::Type::TypeReal64: func( values.asValueArray<kvs::Real64>().data() ); return true;
+    default: break;
+    }
+
+    kvsMessageError() << "Unsupported value type." << std::endl;
+    return false;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Converts the value to Real32 rounding toward the given direction.
+ *  @param  value [in] value
+ *  @param  direction [in] -infinity for min. values, +infinity for max. values
+ *  @return converted value, which does not narrow the range of the value
+ */
+/*===========================================================================*/
+template <typename ValueType>
+inline kvs::Real32 RoundToReal32( const ValueType value, const kvs::Real32 direction )
+{
+    const kvs::Real32 result = kvs::Real32( value );
+    const double d = double( result ) - double( value );
+    if ( ( direction < 0.0f && d > 0.0 ) || ( direction > 0.0f && d < 0.0 ) )
+    {
+        return std::nextafter( result, direction );
+    }
+    return result;
+}
+
+} // end of namespace YYZVis
@@ -54,28 +54,29 @@ YangVolumeImporter::SuperClass* YangVolumeImporter::exec( const kvs::FileFormatB
     auto& yang_value = object["yang_value"].get<kvs::Json::Array>();
     const std::string path_name = kvs::File( json->filename() ).pathName( true );
     const bool swap = BaseClass::needsByteSwap( endian );
-    std::vector<kvs::ValueArray<kvs::Real32>> temp;
+    std::vector<std::string> filenames;
     for ( auto& f : yang_value )
     {
-        const std::string data_file = f.get<std::string>();
-        const std::string filename =
-            ( BaseClass::isAbsolutePath( data_file ) ) ? data_file :
-            ( data_file[0] == '~' ) ? BaseClass::absolutePath( data_file ) :
-            path_name + kvs::File::Separator() + data_file;
-        temp.push_back( BaseClass::readBinary<kvs::Real32>( filename, 4, swap ) );
+        filenames.push_back( BaseClass::dataFilename( path_name, f.get<std::string>() ) );
     }
 
-    auto values = BaseClass::interleaveArrays( temp );
+    auto values = BaseClass::readInterleavedBinary<kvs::Real32>( filenames, 4, swap );
+    if ( values.size() == 0 )
+    {
+        BaseClass::setSuccess( false );
+        kvsMessageError() << "Cannot read the data files." << std::endl;
+        return NULL;
+    }
 
 //    SuperClass::setGridTypeToYang();
     SuperClass::setDimR( dim_rad );
     SuperClass::setDimTheta( dim_lat );
     SuperClass::setDimPhi( dim_lon );
-    SuperClass::setVeclen( temp.size() );
-    SuperClass::calculateCoords();
+    SuperClass::setVeclen( filenames.size() );
     SuperClass::setValues( values );
     SuperClass::updateMinMaxCoords();
     SuperClass::updateMinMaxValues();
+    SuperClass::updateBrickMinMax();
     return this;
 }
 
@@ -1,5 +1,7 @@
 #pragma once
 #include "YinYangVolumeObjectBase.h"
+#include "HexahedralCell.h"
+#include "Philox.h"
 
 
 namespace YYZVis
@@ -8,40 +10,58 @@ namespace YYZVis
 /*===========================================================================*/
 /**
  *  @brief  Interpolation class for Yin-Yang grid.
+ *
+ *  The const bind() and cell() methods give reentrant access to the grid; the
+ *  returned cells are evaluated with explicit local points and random number
+ *  generators, so one grid can be shared by several threads. The other
+ *  methods keep the bound cell and the local point in the grid instance.
  */
 /*===========================================================================*/
 class YinYangGrid
 {
+public:
+    typedef YYZVis::HexahedralCell Cell;
+
 private:
-    kvs::Vec3ui m_base_index; ///< base index of the bound grid
-    kvs::Vec3 m_coords[8];
-    kvs::Real32 m_values[8];
-    mutable kvs::Real32 m_interpolation_functions[8];
-    mutable kvs::Real32 m_differential_functions[24];
-    mutable kvs::Vec3 m_local_point; ///< local point
+    Cell m_cell; ///< bound cell
+    kvs::Real32 m_interpolation_functions[8];
+    kvs::Real32 m_differential_functions[24];
+    kvs::Vec3 m_local_point; ///< local point
     const YYZVis::YinYangVolumeObjectBase* m_reference_volume;
 
 public:
     YinYangGrid( const YYZVis::YinYangVolumeObjectBase* volume );
 
-    const kvs::Vec3ui& baseIndex() const { return m_base_index; }
-    const kvs::Vec3& coord( const size_t index ) const { return m_coords[index]; }
-    const kvs::Real32 value( const size_t index ) const { return m_values[index]; }
+    const kvs::Vec3ui& baseIndex() const { return m_cell.baseIndex(); }
+    const kvs::Vec3& coord( const size_t index ) const { return m_cell.coord( index ); }
+    const kvs::Real32 value( const size_t index ) const { return m_cell.value( index ); }
     const kvs::Vec3& localPoint() const { return m_local_point; }
     const kvs::Real32* interpolationFunctions() const { return m_interpolation_functions; }
     const kvs::Real32* differentialFunctions() const { return m_differential_functions; }
+    const Cell& cell() const { return m_cell; }
+
+    void bind( const kvs::Vec3ui& base_index, Cell* cell ) const;
+    const Cell cell( const kvs::Vec3ui& base_index ) const;
+    void evaluate(
+        const size_t n,
+        const kvs::UInt32* base_indices,
+        const kvs::Real32* p,
+        const kvs::Real32* q,
+        const kvs::Real32* r,
+        kvs::Real32* scalars,
+        kvs::Real32* gradients = NULL ) const;
 
     void bind( const kvs::Vec3ui& base_index );
-    void setLocalPoint( const kvs::Vec3& local ) const;
-    void updateInterpolationFunctions( const kvs::Vec3& local ) const;
-    void updateDifferentialFunctions( const kvs::Vec3& local ) const;
+    void setLocalPoint( const kvs::Vec3& local );
+    void updateInterpolationFunctions( const kvs::Vec3& local );
+    void updateDifferentialFunctions( const kvs::Vec3& local );
     const kvs::Vec3 globalPoint() const;
     const kvs::Mat3 JacobiMatrix() const;
     const kvs::Vec3 center() const;
     const kvs::Real32 volume() const;
     const kvs::Real32 scalar() const;
     const kvs::Vec3 gradientVector() const;
-    const kvs::Vec3 randomSampling() const;
+    const kvs::Vec3 randomSampling( YYZVis::Philox& random );
 };
 
 } // end of namespace YYZVis
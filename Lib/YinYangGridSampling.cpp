@@ -2,121 +2,174 @@
 #include "YinYangVolumeObjectBase.h"
 #include "YinYangGrid.h"
 #include "DensityMap.h"
+#include "BrickMinMax.h"
+#include "ParticleBuffer.h"
+#include "Parallel.h"
+#include "Philox.h"
 #include <kvs/Timer>
 #include <string>
+#include <vector>
+#include <cstring>
 #include <math.h>
 
 namespace
 {
 
-inline kvs::Real32 RandomNumber()
+using YYZVis::Internal::ActiveBricks;
+using YYZVis::Internal::Particle;
+using YYZVis::Internal::Particles;
+using YYZVis::Internal::ParticleBuffer;
+
+/*===========================================================================*/
+/**
+ *  @brief  Checks whether the colors of the two color maps are equal in the range.
+ *  @param  cmap0 [in] color map
+ *  @param  cmap1 [in] color map
+ *  @param  s0 [in] min. scalar value of the range
+ *  @param  s1 [in] max. scalar value of the range
+ *  @return true if at() returns the same colors for the values in [s0,s1]
+ */
+/*===========================================================================*/
+inline bool IsEqual( const kvs::ColorMap& cmap0, const kvs::ColorMap& cmap1, const kvs::Real32 s0, const kvs::Real32 s1 )
 {
-    static kvs::UInt32 x=123456789,y=362436069,z=521288629,w=88675123;
-    kvs::UInt32 t;
-    t=(x^(x<<11));
-    x=y;y=z;z=w;
-    w=(w^(w>>19))^(t^(t>>8));
-    return w * ( 1.0f / 4294967296.0f );
-}
+    if ( cmap0.resolution() != cmap1.resolution() ) { return false; }
+    if ( cmap0.minValue() != cmap1.minValue() || cmap0.maxValue() != cmap1.maxValue() ) { return false; }
+
+    const size_t dims = cmap0.resolution() - 1;
+    const kvs::Real32 min_value = cmap0.minValue();
+    const kvs::Real32 scale = dims / ( cmap0.maxValue() - min_value );
+    const kvs::Real32 v0 = kvs::Math::Clamp( ( s0 - min_value ) * scale, 0.0f, kvs::Real32( dims ) );
+    const kvs::Real32 v1 = kvs::Math::Clamp( ( s1 - min_value ) * scale, 0.0f, kvs::Real32( dims ) );
+    const size_t i0 = static_cast<size_t>( v0 );
+    const size_t i1 = kvs::Math::Min( static_cast<size_t>( v1 ) + 1, dims );
+    for ( size_t i = i0; i <= i1; i++ )
+    {
+        const kvs::RGBColor c0 = cmap0[i];
+        const kvs::RGBColor c1 = cmap1[i];
+        if ( c0.r() != c1.r() || c0.g() != c1.g() || c0.b() != c1.b() ) { return false; }
+    }
 
+    return true;
 }
 
-
-namespace
-{
-
-struct Particle
-{
-    kvs::Vec3 coord; ///< coordinate value
-    kvs::Vec3 normal; ///< normal vector
-    kvs::Real32 scalar; ///< scalar value
-};
-
-class Particles
-{
-private:
-    std::vector<kvs::Real32> m_coords; ///< coorinate value array
-    std::vector<kvs::Real32> m_normals; ///< normal vector array
-    std::vector<kvs::UInt8> m_colors; ///< color value array
-
-public:
-    Particles() {}
-    kvs::ValueArray<kvs::Real32> coords() const { return kvs::ValueArray<kvs::Real32>( m_coords ); }
-    kvs::ValueArray<kvs::Real32> normals() const { return kvs::ValueArray<kvs::Real32>( m_normals ); }
-    kvs::ValueArray<kvs::UInt8> colors() const { return kvs::ValueArray<kvs::UInt8>( m_colors ); }
-    void push( const Particle& particle, const kvs::ColorMap& color_map )
-    {
-        const kvs::RGBColor color = color_map.at( particle.scalar );
-        m_coords.push_back( particle.coord.x() );
-        m_coords.push_back( particle.coord.y() );
-        m_coords.push_back( particle.coord.z() );
-        m_normals.push_back( particle.normal.x() );
-        m_normals.push_back( particle.normal.y() );
-        m_normals.push_back( particle.normal.z() );
-        m_colors.push_back( color.r() );
-        m_colors.push_back( color.g() );
-        m_colors.push_back( color.b() );
-    }
-};
-
 class Sampler
 {
 private:
     YYZVis::YinYangGrid* m_grid;
     YYZVis::DensityMap* m_density_map;
-    Particles m_particles; ///< particles
+    Particles* m_particles; ///< particles (reference)
     Particle m_current; ///< current sampled point
     Particle m_trial; ///< trial point
+    YYZVis::Philox m_random; ///< random number generator
+    kvs::UInt32 m_stream; ///< stream of the random numbers
+    size_t m_cell_index; ///< index of the bound cell
+    kvs::Real32 m_region_q[6]; ///< local theta coordinates of the vertices of the non-overlap region
+    kvs::Real32 m_region_s[6]; ///< local phi coordinates of the vertices of the non-overlap region
+    kvs::Real32 m_region_areas[4]; ///< cumulative areas of the triangles before each triangle
+    kvs::Real32 m_region_area; ///< area of the non-overlap region
+    size_t m_region_size; ///< number of the vertices of the non-overlap region
     //kvs::Real32 m_overlap_weight; //overlap weight of point( j, k ) : ( j = theta, k = phi )
 
 public:
     Sampler(
         YYZVis::YinYangGrid* grid,
-        YYZVis::DensityMap* density_map ):
+        YYZVis::DensityMap* density_map,
+        const kvs::UInt32 seed = 0,
+        const kvs::UInt32 stream = 0 ):
         m_grid( grid ),
-        m_density_map( density_map ) {}
+        m_density_map( density_map ),
+        m_particles( NULL ),
+        m_random( seed ),
+        m_stream( stream ),
+        m_cell_index( 0 ),
+        m_region_area( 0.0f ),
+        m_region_size( 0 ) {}
+
+    const Particles& particles() const { return *m_particles; }
+    void attachParticles( Particles* particles ) { m_particles = particles; }
 
-    const Particles& particles() const { return m_particles; }
+    kvs::Real32 random() { return m_random(); }
 
-    void bind( const kvs::Vec3ui& base_index )
+    void bind( const kvs::Vec3ui& base_index, const size_t cell_index )
     {
+        // The random numbers of the cell are keyed by (seed, stream, cell index).
         m_grid->bind( base_index );
+        m_cell_index = cell_index;
+        m_random.setCounter( m_stream, cell_index );
+    }
+
+    void setStream( const kvs::UInt32 stream )
+    {
+        m_stream = stream;
+        m_random.setCounter( m_stream, m_cell_index );
     }
 
     size_t numberOfParticles( const YYZVis::YinYangVolumeObjectBase* object )
+    {
+        return this->numberOfParticles( this->expectedNumberOfParticles( object ) );
+    }
+
+    size_t numberOfParticles( const kvs::Real32 expected )
+    {
+        // Stochastic rounding of the expected number.
+        const kvs::Real32 R = m_random();
+        size_t n = static_cast<size_t>( expected );
+        if ( expected - n > R ) { ++n; }
+        return n;
+    }
+
+    size_t poissonNumberOfParticles( const kvs::Real32 expected )
+    {
+        // Poisson distributed number with the mean of the expected number. The
+        // mean is split into the chunks (<= 30) drawn by the multiplication
+        // method, since the sum of Poisson numbers is also a Poisson number.
+        const kvs::Real32 chunk = 30.0f;
+        size_t n = 0;
+        for ( kvs::Real32 mean = expected; mean > 0.0f; mean -= chunk )
+        {
+            const kvs::Real32 L = std::exp( -kvs::Math::Min( mean, chunk ) );
+            kvs::Real32 p = m_random();
+            while ( p > L ) { p *= m_random(); n++; }
+        }
+        return n;
+    }
+
+    kvs::Real32 expectedNumberOfParticles( const YYZVis::YinYangVolumeObjectBase* object )
     {
         const kvs::Real32 scalar = this->averaged_scalar();
         kvs::Real32 density;
         density =  m_density_map->at( scalar );
-        const kvs::Real32 volume = m_grid->volume();
-        return this->number_of_particles( density, volume );
+        const kvs::Vec3ui& base = m_grid->baseIndex();
+        const kvs::Real32 volume = object->cellVolume( base.x(), base.y(), base.z() );
+        return density * volume;
     }
 
-    size_t numberOfParticles( const YYZVis::YinYangVolumeObjectBase* object, size_t overlap_flag )
+    kvs::Real32 expectedNumberOfParticles( const YYZVis::YinYangVolumeObjectBase* object, const kvs::Real32 overlap_weight )
     {
         const kvs::Real32 scalar = this->averaged_scalar();
         kvs::Real32 density;
-        kvs::Real32 overlap_weight;
+        density = m_density_map->at( scalar ) * overlap_weight;
+
+        const kvs::Vec3ui& base = m_grid->baseIndex();
+        const kvs::Real32 volume = object->cellVolume( base.x(), base.y(), base.z() );
+        return density * volume;
+    }
+
+    kvs::Real32 overlapWeight( const YYZVis::YinYangVolumeObjectBase* object, const size_t overlap_flag ) const
+    {
         if( overlap_flag == 0 )
         {
-            overlap_weight = 1.0f;
+            return 1.0f;
         }
         else if( overlap_flag == 255 )
         {
-            overlap_weight = 0.0f;
+            return 0.0f;
         }
         else
         {
-            //std::cout << "checkflag = " << overlap_flag << std::endl;
-            //overlap_weight = 0.0f;
             //overlap_weight = number_of_flags( checkOverlapFlag( object ) ) / 8.0f;
-            overlap_weight = calc_yinyang_overlap_weight( object );
-            //std::cout << "overlap_weight = " << overlap_weight << std::endl;
+            return calc_yinyang_overlap_weight( object );
         }
-        density = m_density_map->at( scalar ) * overlap_weight;
-
-        const kvs::Real32 volume = m_grid->volume();
-        return this->number_of_particles( density, volume );
     }
 
     kvs::Vec3 getGridCoords( size_t index)
@@ -126,7 +179,7 @@ public:
 
     kvs::Real32 sample()
     {
-        m_current.coord = m_grid->randomSampling();
+        m_current.coord = this->random_sampling();
         m_current.normal = -m_grid->gradientVector();
         m_current.scalar = m_grid->scalar();
         return m_density_map->at( m_current.scalar );
@@ -157,40 +210,69 @@ public:
 
     kvs::Real32 trySample()
     {
-        m_trial.coord = m_grid->randomSampling();
+        m_trial.coord = this->random_sampling();
         m_trial.normal = -m_grid->gradientVector();
         m_trial.scalar = m_grid->scalar();
         return m_density_map->at( m_current.scalar );
     }
 
-    kvs::Real32 sampleOverlap( const YYZVis::YinYangVolumeObjectBase* object, size_t& sample_stoper )
+    void bindNonOverlapRegion( const YYZVis::YinYangVolumeObjectBase* object )
     {
-        size_t counter = 0;
-        while( 1 )
+        // The region of the cell outside of the counterpart grid is the unit
+        // square in the local (theta, phi) coordinates clipped by the line
+        // interpolating the zero crossings of the pyramid function on the
+        // edges, as assumed in overlap_weight().
+        const ControlVolume cv = this->control_volume( object );
+        const kvs::Real32 q[4] = { 0.0f, 1.0f, 1.0f, 0.0f };
+        const kvs::Real32 s[4] = { 0.0f, 0.0f, 1.0f, 1.0f };
+        const kvs::Real32 f[4] = { cv.f12, cv.f22, cv.f21, cv.f11 };
+
+        m_region_size = 0;
+        for ( size_t i = 0; i < 4; i++ )
         {
-            m_current.coord = m_grid->randomSampling();
-            counter++;
-            if( judge_yinyang_overlap( object, m_current.coord ) == 0 ) break;
-            else if( counter > 500000 )
+            const size_t j = ( i + 1 ) % 4;
+            if ( overlap_flag( f[i] ) == 0 )
+            {
+                m_region_q[ m_region_size ] = q[i];
+                m_region_s[ m_region_size ] = s[i];
+                m_region_size++;
+            }
+            if ( overlap_flag( f[i] ) != overlap_flag( f[j] ) )
             {
-                sample_stoper = 1;
-                //std::cout << "sample stop." << std::endl;
-                break;
+                const kvs::Real32 t = f[i] / ( f[i] - f[j] );
+                m_region_q[ m_region_size ] = q[i] + ( q[j] - q[i] ) * t;
+                m_region_s[ m_region_size ] = s[i] + ( s[j] - s[i] ) * t;
+                m_region_size++;
             }
         }
+
+        // The region is convex except for the diagonal patterns (six vertices),
+        // whose overlap weights are zero, so it is divided into the triangle fan.
+        m_region_area = 0.0f;
+        if ( m_region_size > 5 ) { return; }
+        for ( size_t i = 1; i + 1 < m_region_size; i++ )
+        {
+            m_region_areas[ i - 1 ] = m_region_area;
+            m_region_area += this->triangle_area( 0, i, i + 1 );
+        }
+    }
+
+    kvs::Real32 sampleOverlap()
+    {
+        m_current.coord = this->random_sampling_non_overlap();
         m_current.normal = -m_grid->gradientVector();
         m_current.scalar = m_grid->scalar();
         return m_density_map->at( m_current.scalar );
     }
 
-    kvs::Real32 sampleOverlap( const size_t max_loops, const YYZVis::YinYangVolumeObjectBase* object, size_t& sample_stoper )
+    kvs::Real32 sampleOverlap( const size_t max_loops )
     {
-        kvs::Real32 density = this->sampleOverlap( object, sample_stoper );
+        kvs::Real32 density = this->sampleOverlap();
         if ( kvs::Math::IsZero( density ) )
         {
             for ( size_t i = 0; i < max_loops; i++ )
             {
-                density = this->sampleOverlap( object, sample_stoper );
+                density = this->sampleOverlap();
                 if ( !kvs::Math::IsZero( density ) ) { break; }
             }
         }
@@ -198,20 +280,9 @@ public:
         return density;
     }
 
-    kvs::Real32 trySampleOverlap( const YYZVis::YinYangVolumeObjectBase* object, size_t& sample_stoper )
+    kvs::Real32 trySampleOverlap()
     {
-        size_t counter = 0;
-        while( 1 )
-        {
-            m_trial.coord = m_grid->randomSampling();
-            counter++;
-            if( judge_yinyang_overlap( object, m_trial.coord ) == 0 ) break;
-            else if( counter > 500000 )
-            {
-                sample_stoper = 1;
-                break;
-            }
-        }
+        m_trial.coord = this->random_sampling_non_overlap();
         m_trial.normal = -m_grid->gradientVector();
         m_trial.scalar = m_grid->scalar();
         return m_density_map->at( m_current.scalar );
@@ -219,17 +290,178 @@ public:
 
     void accept( const kvs::ColorMap& cmap )
     {
-        m_particles.push( m_current, cmap );
+        m_particles->push( m_current, cmap );
     }
 
     void acceptTrial( const kvs::ColorMap& cmap )
     {
-        m_particles.push( m_trial, cmap );
+        m_particles->push( m_trial, cmap );
         m_current.coord = m_trial.coord;
         m_current.normal = m_trial.normal;
         m_current.scalar = m_trial.scalar;
     }
 
+    void metropolis( const size_t nparticles, const kvs::ColorMap& cmap )
+    {
+        const size_t max_loops = nparticles * 10;
+        size_t nduplications = 0;
+        size_t counter = 0;
+        kvs::Real32 density = this->sample( max_loops );
+        while ( counter < nparticles )
+        {
+            const kvs::Real32 density_trial = this->trySample();
+            const kvs::Real32 ratio = density_trial / density;
+            if ( ratio >= 1.0f )
+            {
+                this->acceptTrial( cmap );
+                density = density_trial;
+                counter++;
+            }
+            else
+            {
+                if ( ratio >= m_random() )
+                {
+                    this->acceptTrial( cmap );
+                    density = density_trial;
+                    counter++;
+                }
+                else
+                {
+#ifdef DUPLICATION
+                    this->accept( cmap );
+                    counter++;
+#else
+                    if ( ++nduplications > max_loops )
+                    {
+                        // As in the Metropolis-Hastings algorithm, the remaining
+                        // particles stay at the current point, so the cell keeps
+                        // the number of particles allocated in the first pass.
+                        if ( density > 0.0f )
+                        {
+                            for ( ; counter < nparticles; counter++ ) { this->accept( cmap ); }
+                        }
+                        break;
+                    }
+#endif
+                }
+            }
+        } // end of while-loop
+    }
+
+    void uniform( const size_t nparticles, const kvs::ColorMap& cmap )
+    {
+        for ( size_t counter = 0; counter < nparticles; counter++ )
+        {
+            this->sample();
+            this->accept( cmap );
+        }
+    }
+
+    void uniformOverlap( const size_t nparticles, const YYZVis::YinYangVolumeObjectBase* object, const kvs::ColorMap& cmap )
+    {
+        this->bindNonOverlapRegion( object );
+        for ( size_t counter = 0; counter < nparticles; counter++ )
+        {
+            this->sampleOverlap();
+            this->accept( cmap );
+        }
+    }
+
+    void rejection( const size_t nparticles, const kvs::Real32 max_density, const kvs::ColorMap& cmap )
+    {
+        // A point is accepted with the probability density / max_density, so
+        // the particles are independent of each other.
+        if ( !( max_density > 0.0f ) ) { return; }
+        const size_t max_loops = 1000;
+        size_t nrejections = 0;
+        size_t counter = 0;
+        while ( counter < nparticles )
+        {
+            const kvs::Real32 density = this->sample();
+            if ( m_random() * max_density < density )
+            {
+                this->accept( cmap );
+                nrejections = 0;
+                counter++;
+            }
+            else
+            {
+                if ( ++nrejections > max_loops ) { break; }
+            }
+        }
+    }
+
+    void rejectionOverlap( const size_t nparticles, const YYZVis::YinYangVolumeObjectBase* object, const kvs::Real32 max_density, const kvs::ColorMap& cmap )
+    {
+        if ( !( max_density > 0.0f ) ) { return; }
+        const size_t max_loops = 1000;
+        size_t nrejections = 0;
+        size_t counter = 0;
+        this->bindNonOverlapRegion( object );
+        while ( counter < nparticles )
+        {
+            const kvs::Real32 density = this->sampleOverlap();
+            if ( m_random() * max_density < density )
+            {
+                this->accept( cmap );
+                nrejections = 0;
+                counter++;
+            }
+            else
+            {
+                if ( ++nrejections > max_loops ) { break; }
+            }
+        }
+    }
+
+    void metropolisOverlap( const size_t nparticles, const YYZVis::YinYangVolumeObjectBase* object, const kvs::ColorMap& cmap )
+    {
+        const size_t max_loops = nparticles * 10;
+        size_t nduplications = 0;
+        size_t counter = 0;
+        this->bindNonOverlapRegion( object );
+        kvs::Real32 density = this->sampleOverlap( max_loops );
+        while ( counter < nparticles )
+        {
+            const kvs::Real32 density_trial = this->trySampleOverlap();
+            const kvs::Real32 ratio = density_trial / density;
+            if ( ratio >= 1.0f )
+            {
+                this->acceptTrial( cmap );
+                density = density_trial;
+                counter++;
+            }
+            else
+            {
+                if ( ratio >= m_random() )
+                {
+                    this->acceptTrial( cmap );
+                    density = density_trial;
+                    counter++;
+                }
+                else
+                {
+#ifdef DUPLICATION
+                    this->accept( cmap );
+                    counter++;
+#else
+                    if ( ++nduplications > max_loops )
+                    {
+                        // As in the Metropolis-Hastings algorithm, the remaining
+                        // particles stay at the current point, so the cell keeps
+                        // the number of particles allocated in the first pass.
+                        if ( density > 0.0f )
+                        {
+                            for ( ; counter < nparticles; counter++ ) { this->accept( cmap ); }
+                        }
+                        break;
+                    }
+#endif
+                }
+            }
+        } // end of while-loop
+    }
+
     size_t checkOverlapFlag( const YYZVis::YinYangVolumeObjectBase* object ) const
     {
         kvs::Real32 tht_max;
@@ -284,6 +516,43 @@ public:
 
 private:
 
+    kvs::Vec3 random_sampling()
+    {
+        return m_grid->randomSampling( m_random );
+    }
+
+    kvs::Vec3 random_sampling_non_overlap()
+    {
+        // The whole cell is used if the region is degenerated.
+        if ( !( m_region_area > 0.0f ) ) { return this->random_sampling(); }
+
+        // Select a triangle with the probability proportional to its area,
+        // and a point uniformly in the triangle.
+        const kvs::Real32 p = m_random();
+        const kvs::Real32 area = m_random() * m_region_area;
+        size_t i = 1;
+        while ( i + 2 < m_region_size && m_region_areas[i] <= area ) { i++; }
+
+        const kvs::Real32 u = std::sqrt( m_random() );
+        const kvs::Real32 v = m_random();
+        const kvs::Real32 w0 = 1.0f - u;
+        const kvs::Real32 w1 = u * ( 1.0f - v );
+        const kvs::Real32 w2 = u * v;
+        const kvs::Real32 q = w0 * m_region_q[0] + w1 * m_region_q[i] + w2 * m_region_q[ i + 1 ];
+        const kvs::Real32 s = w0 * m_region_s[0] + w1 * m_region_s[i] + w2 * m_region_s[ i + 1 ];
+        m_grid->setLocalPoint( kvs::Vec3( p, q, s ) );
+        return m_grid->globalPoint();
+    }
+
+    kvs::Real32 triangle_area( const size_t i0, const size_t i1, const size_t i2 ) const
+    {
+        const kvs::Real32 dq1 = m_region_q[i1] - m_region_q[i0];
+        const kvs::Real32 ds1 = m_region_s[i1] - m_region_s[i0];
+        const kvs::Real32 dq2 = m_region_q[i2] - m_region_q[i0];
+        const kvs::Real32 ds2 = m_region_s[i2] - m_region_s[i0];
+        return kvs::Math::Abs( dq1 * ds2 - dq2 * ds1 ) * 0.5f;
+    }
+
     //---YinYangの重複部分の重み計算---------------
     struct ControlVolume
     {
@@ -457,6 +726,11 @@ private:
     }
 
     kvs::Real32 calc_yinyang_overlap_weight( const YYZVis::YinYangVolumeObjectBase* object ) const
+    {
+        return overlap_weight( control_volume( object ) );
+    }
+
+    ControlVolume control_volume( const YYZVis::YinYangVolumeObjectBase* object ) const
     {
         kvs::Real32 r[5], tht[5], phi[5], x[5], y[5], z[5], tht_n, tht_s, phi_w, phi_e;
         std::string c11, c12, c21, c22;
@@ -512,38 +786,7 @@ private:
         cv.pattern_flag += overlap_flag( cv.f21 ) * 2; //0010
         cv.pattern_flag += overlap_flag( cv.f22 );     //0001
 
-        return overlap_weight( cv );
-    }
-
-    size_t judge_yinyang_overlap( const YYZVis::YinYangVolumeObjectBase* object, kvs::Vec3 coords ) const
-    {
-        kvs::Real32 r = sqrt( coords.x()*coords.x() + coords.y()*coords.y() + coords.z()*coords.z() );
-        kvs::Real32 tht = acos( coords.z() / r );
-        kvs::Real32 phi = atan2( coords.y(), coords.x() );
-        kvs::Real32 tht_max;
-        kvs::Real32 tht_min;
-        kvs::Real32 phi_max;
-        kvs::Real32 phi_min;
-
-        const size_t dim_theta = object->dimTheta();
-        const size_t dim_phi = object->dimPhi();
-
-        RangeYY range_theta = { object->rangeTheta().min, object->rangeTheta().max, object->rangeTheta().d };
-        RangeYY range_phi = { object->rangePhi().min, object->rangePhi().max, object->rangePhi().d };
-
-        tht_min = range_theta.min + range_theta.d * ( 0 - 1 );
-        tht_max = range_theta.min + range_theta.d * ( ( dim_theta - 1 ) - 1 );
-        phi_min = range_phi.min + range_phi.d * ( 0 - 2 );
-        phi_max = range_phi.min + range_phi.d * ( ( dim_phi - 1 ) - 2 );
-
-        if ( tht_min < tht && tht < tht_max && phi_min < phi && phi < phi_max )
-        {
-            return 1;
-        }
-        else
-        {
-            return 0;
-        }
+        return cv;
     }
 
     kvs::Real32 number_of_flags( size_t flag ) const
@@ -572,23 +815,66 @@ private:
             m_grid->value(6) +
             m_grid->value(7) ) / 8.0f;
     }
+};
 
-    size_t number_of_particles( const kvs::Real32 density, const kvs::Real32 volume ) const
-    {
-        const kvs::Real32 R = ::RandomNumber();
-        const kvs::Real32 N = density * volume;
-        size_t n = static_cast<size_t>( N );
-        if ( N - n > R ) { ++n; }
-        return n;
-    }
+/*===========================================================================*/
+/**
+ *  @brief  Calculates the overlap flags and weights of the cells of the yang grid.
+ *  @param  volume [in] pointer to the yang volume object
+ *  @param  nthreads [in] number of threads
+ *  @param  flags [out] overlap flag of each cell in (theta, phi)
+ *  @param  weights [out] overlap weight of each cell in (theta, phi)
+ *
+ *  The flag and the weight depend only on the latitude and longitude of the
+ *  nodes, so they are calculated for the cells of the innermost layer and
+ *  shared by all of the cells along r. The index of the cell (j,k) is
+ *  j + (dim_theta - 1) * k.
+ */
+/*===========================================================================*/
+inline void CreateOverlapTable(
+    const YYZVis::YinYangVolumeObjectBase* volume,
+    const size_t nthreads,
+    std::vector<kvs::UInt8>* flags,
+    std::vector<kvs::Real32>* weights )
+{
+    const size_t dim_theta = volume->dimTheta(); // latitude
+    const size_t dim_phi = volume->dimPhi(); // longitude
+    flags->assign( ( dim_theta - 1 ) * ( dim_phi - 1 ), 0 );
+    weights->assign( ( dim_theta - 1 ) * ( dim_phi - 1 ), 1.0f );
 
-};
+    YYZVis::Parallel::For( 0, dim_phi - 1, [&]( const size_t k )
+    {
+        YYZVis::YinYangGrid grid( volume );
+        ::Sampler sampler( &grid, NULL );
+        for ( size_t j = 0, index = ( dim_theta - 1 ) * k; j < dim_theta - 1; j++, index++ )
+        {
+            sampler.bind( kvs::Vec3ui( 0, j, k ), index );
+            const size_t flag = sampler.checkOverlapFlag( volume );
+            (*flags)[index] = kvs::UInt8( flag );
+            (*weights)[index] = sampler.overlapWeight( volume, flag );
+        }
+    }, nthreads );
+}
 
 }
 
 
 namespace YYZVis
 {
+YinYangGridSampling::YinYangGridSampling():
+    kvs::MapperBase(),
+    kvs::PointObject(),
+    m_camera( 0 ),
+    m_subpixel_level( 1 ),
+    m_sampling_step( 0.5f ),
+    m_object_depth( 0.0f ),
+    m_nthreads( 0 ),
+    m_seed( 0 ),
+    m_nensembles( 1 ),
+    m_sampling_method( Metropolis )
+{
+}
+
 YinYangGridSampling::YinYangGridSampling(
     const kvs::VolumeObjectBase* volume,
     const size_t subpixel_level,
@@ -597,7 +883,11 @@ YinYangGridSampling::YinYangGridSampling(
     const kvs::Real32 object_depth ):
     kvs::MapperBase( transfer_function ),
     kvs::PointObject(),
-    m_camera( 0 )
+    m_camera( 0 ),
+    m_nthreads( 0 ),
+    m_seed( 0 ),
+    m_nensembles( 1 ),
+    m_sampling_method( Metropolis )
 {
     this->setSubpixelLevel( subpixel_level );
     this->setSamplingStep( sampling_step );
@@ -611,7 +901,11 @@ YinYangGridSampling::YinYangGridSampling(
     const size_t subpixel_level,
     const kvs::Real32 sampling_step,
     const kvs::TransferFunction& transfer_function,
-    const kvs::Real32 object_depth )
+    const kvs::Real32 object_depth ):
+    m_nthreads( 0 ),
+    m_seed( 0 ),
+    m_nensembles( 1 ),
+    m_sampling_method( Metropolis )
 {
     this->attachCamera( camera );
     this->setSubpixelLevel( subpixel_level );
@@ -621,6 +915,30 @@ YinYangGridSampling::YinYangGridSampling(
 }
 
 YinYangGridSampling::SuperClass* YinYangGridSampling::exec( const kvs::ObjectBase* object )
+{
+    return this->mapping( object, false );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Regenerates the particles for the new transfer function.
+ *  @param  transfer_function [in] transfer function
+ *  @return pointer to the point object
+ *
+ *  The particles of the cells, whose densities and colors are not changed
+ *  in the value range of the cell, are copied from the current particles,
+ *  and only the other cells are sampled again. The attached volume must not
+ *  be modified since the last execution. The result is identical to exec()
+ *  with the new transfer function.
+ */
+/*===========================================================================*/
+YinYangGridSampling::SuperClass* YinYangGridSampling::resample( const kvs::TransferFunction& transfer_function )
+{
+    BaseClass::setTransferFunction( transfer_function );
+    return this->mapping( BaseClass::volume(), true );
+}
+
+YinYangGridSampling::SuperClass* YinYangGridSampling::mapping( const kvs::ObjectBase* object, const bool reuse )
 {
     if ( !object )
     {
@@ -644,15 +962,8 @@ YinYangGridSampling::SuperClass* YinYangGridSampling::exec( const kvs::ObjectBas
         delete_camera = true;
     }
 
-    const YYZVis::YinYangVolumeObjectBase* yin_yang_object = YYZVis::YinYangVolumeObjectBase::DownCast( volume );
-    if ( yin_yang_object->gridType() == yin_yang_object->gridYin() )
-    {
-        this->mapping_metro_yin( YYZVis::YinYangVolumeObjectBase::DownCast( volume ) );
-    }
-    else
-    {
-        this->mapping_metro_yang( YYZVis::YinYangVolumeObjectBase::DownCast( volume ) );
-    }
+    const YYZVis::YinYangVolumeObjectBase* yvolume = YYZVis::YinYangVolumeObjectBase::DownCast( volume );
+    this->mapping_cells( yvolume, reuse );
 
     if ( delete_camera )
     {
@@ -663,14 +974,74 @@ YinYangGridSampling::SuperClass* YinYangGridSampling::exec( const kvs::ObjectBas
     return this;
 }
 
-void YinYangGridSampling::mapping_metro_yin( const YYZVis::YinYangVolumeObjectBase* volume ) //Yin-grid Metropolis sampling.
+/*===========================================================================*/
+/**
+ *  @brief  Returns a point object of the ensemble member.
+ *  @param  index [in] index of the ensemble member
+ *  @return point object including the particles of the member
+ *
+ *  When the member has all the particles (single member), the particle
+ *  arrays are shared with this object without copying. The arrays are never
+ *  modified in place, since the sampling sets newly allocated arrays.
+ */
+/*===========================================================================*/
+kvs::PointObject* YinYangGridSampling::newEnsemble( const size_t index ) const
+{
+    KVS_ASSERT( index < m_nensembles );
+
+    const size_t offset = m_ensemble_offsets[ index ] * 3;
+    const size_t size = ( m_ensemble_offsets[ index + 1 ] - m_ensemble_offsets[ index ] ) * 3;
+    kvs::PointObject* object = new kvs::PointObject();
+    if ( size == SuperClass::coords().size() )
+    {
+        object->setCoords( SuperClass::coords() );
+        object->setColors( SuperClass::colors() );
+        object->setNormals( SuperClass::normals() );
+    }
+    else
+    {
+        object->setCoords( kvs::ValueArray<kvs::Real32>( SuperClass::coords().data() + offset, size ) );
+        object->setColors( kvs::ValueArray<kvs::UInt8>( SuperClass::colors().data() + offset, size ) );
+        object->setNormals( kvs::ValueArray<kvs::Real32>( SuperClass::normals().data() + offset, size ) );
+    }
+    object->setSize( 1.0f );
+    object->setMinMaxObjectCoords( SuperClass::minObjectCoord(), SuperClass::maxObjectCoord() );
+    object->setMinMaxExternalCoords( SuperClass::minExternalCoord(), SuperClass::maxExternalCoord() );
+    return object;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Sets the offsets of the ensemble members from the compacted slices.
+ *  @param  sizes [in] number of particles of each slice (member-major)
+ *  @param  nslices [in] number of slices per member
+ */
+/*===========================================================================*/
+void YinYangGridSampling::set_ensemble_offsets( const std::vector<size_t>& sizes, const size_t nslices )
+{
+    m_ensemble_offsets.assign( m_nensembles + 1, 0 );
+    for ( size_t e = 0; e < m_nensembles; e++ )
+    {
+        size_t nparticles = 0;
+        for ( size_t k = 0; k < nslices; k++ ) { nparticles += sizes[ e * nslices + k ]; }
+        m_ensemble_offsets[ e + 1 ] = m_ensemble_offsets[ e ] + nparticles;
+    }
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Generates particles in the cells of the yin or yang grid.
+ *  @param  volume [in] pointer to the yin or yang volume object
+ *  @param  reuse [in] if true, the particles of the unchanged cells are reused
+ */
+/*===========================================================================*/
+void YinYangGridSampling::mapping_cells( const YYZVis::YinYangVolumeObjectBase* volume, const bool reuse )
 {
     KVS_ASSERT( volume != NULL );
     BaseClass::attachVolume( volume );
     BaseClass::setRange( volume );
     BaseClass::setMinMaxCoords( volume, this );
 
-    YYZVis::YinYangGrid grid( volume );
     YYZVis::DensityMap density_map;
     density_map.setSubpixelLevel( m_subpixel_level );
     density_map.setSamplingStep( m_sampling_step );
@@ -678,298 +1049,242 @@ void YinYangGridSampling::mapping_metro_yin( const YYZVis::YinYangVolumeObjectBa
     density_map.attachObject( volume );
     density_map.create( BaseClass::transferFunction().opacityMap() );
 
-    ::Sampler sampler( &grid, &density_map );
     const size_t dim_r = volume->dimR(); // radius
     const size_t dim_theta = volume->dimTheta(); // latitude
     const size_t dim_phi = volume->dimPhi(); // longitude
+    const size_t nensembles = m_nensembles;
+    const bool yang = volume->gridType() == volume->gridYang();
     const kvs::ColorMap color_map( BaseClass::transferFunction().colorMap() );
-    kvs::Timer timer;
     kvs::Timer timer2;
-    float sum=0.0f;
-
-    size_t size = ( dim_phi - 1 ) * ( dim_theta - 1 ) * ( dim_r - 1 );
-    float* nparticles = new float[size];
 
-    timer.start();
-    size_t index = 0;
-    for ( size_t k = 0; k < dim_phi - 1; k++ )
+    // The cells in the bricks, whose densities are zero in the value range,
+    // are skipped since no particles are generated in them.
+    const kvs::Vec3ui resolution( dim_r, dim_theta, dim_phi );
+    YYZVis::BrickMinMax bricks = volume->brickMinMax();
+    if ( !bricks.isValid( volume->values(), resolution ) && volume->veclen() == 1 ) { bricks.create( volume->values(), resolution ); }
+    const std::vector<kvs::UInt8> active_bricks = ::ActiveBricks( bricks, density_map );
+
+    // The cells are partitioned into the slabs along phi. The expected numbers
+    // of particles of the cells are calculated first, and each slab is then
+    // sampled into its slices of the preallocated output by a worker with its
+    // own grid. The ensemble member e of a cell uses the random number streams
+    // 2e (number of particles) and 2e+1 (sampling), and is written into the
+    // slice e * nslabs + k, so that the members are stored contiguously.
+    const size_t nslabs = dim_phi - 1;
+    const size_t slab_size = ( dim_theta - 1 ) * ( dim_r - 1 );
+    const size_t ncells = nslabs * slab_size;
+    const size_t nslices = nensembles * nslabs;
+    std::vector<kvs::Real32> nexpected( ncells, 0.0f );
+    std::vector<kvs::UInt32> cell_nparticles( nensembles * ncells, 0 );
+    std::vector<size_t> slice_nparticles( nslices, 0 );
+
+    // The overlap flags and weights of the yang cells (see CreateOverlapTable).
+    std::vector<kvs::UInt8> overlap_flag;
+    std::vector<kvs::Real32> overlap_weight;
+    if ( yang ) { ::CreateOverlapTable( volume, m_nthreads, &overlap_flag, &overlap_weight ); }
+
+    // The particles of a cell can be reused when the densities and the colors
+    // are not changed in the value range of the cell. The particles of the
+    // cells are stored in the cell order in each slice.
+    const bool cached = reuse &&
+        m_cell_min_values.size() == ncells &&
+        m_cell_nparticles.size() == nensembles * ncells;
+    std::vector<kvs::UInt8> reused( cached ? ncells : 0, 0 );
+    std::vector<size_t> old_slice_offsets( cached ? nslices : 0, 0 );
+    const kvs::ValueArray<kvs::Real32> old_coords = cached ? SuperClass::coords() : kvs::ValueArray<kvs::Real32>();
+    const kvs::ValueArray<kvs::Real32> old_normals = cached ? SuperClass::normals() : kvs::ValueArray<kvs::Real32>();
+    const kvs::ValueArray<kvs::UInt8> old_colors = cached ? SuperClass::colors() : kvs::ValueArray<kvs::UInt8>();
+    if ( !cached )
     {
-        for ( size_t j = 0; j < dim_theta - 1; j++ )
-        {
-            for ( size_t i = 0; i < dim_r - 1; i++, index++ )
-            {
-                sampler.bind( kvs::Vec3ui( i, j, k ) );
-                nparticles[index] = sampler.numberOfParticles( volume );
-            }
-        }
+        m_cell_min_values.assign( ncells, 0.0f );
+        m_cell_max_values.assign( ncells, 0.0f );
     }
-    timer.stop();
-//    std::cout << "Calculate number of particles." << timer.sec() << " sec" << std::endl;
 
-    index = 0;
     timer2.start();
-    for ( size_t k = 0; k < dim_phi - 1; k++ )
+    Parallel::For( 0, nslabs, [&]( const size_t k )
     {
+        YYZVis::YinYangGrid grid( volume );
+        ::Sampler sampler( &grid, &density_map, m_seed );
+
+        size_t index = k * slab_size;
         for ( size_t j = 0; j < dim_theta - 1; j++ )
         {
             for ( size_t i = 0; i < dim_r - 1; i++, index++ )
             {
-                sampler.bind( kvs::Vec3ui( i, j, k ) );
-                const size_t max_loops = nparticles[index] * 10;
-                if ( nparticles[index] == 0 ) continue;
-                size_t nduplications = 0;
-                size_t counter = 0;
-                kvs::Real32 density =  sampler.sample( max_loops );
-                while ( counter < nparticles[index] )
+                if ( cached )
                 {
-                    const kvs::Real32 density_trial = sampler.trySample();
-                    const kvs::Real32 ratio = density_trial / density;
-                    if ( ratio >= 1.0f )
+                    for ( size_t e = 0; e < nensembles; e++ )
                     {
-                        sampler.acceptTrial( color_map );
-                        density = density_trial;
-                        counter++;
+                        old_slice_offsets[ e * nslabs + k ] += m_cell_nparticles[ e * ncells + index ];
                     }
-                    else
+
+                    const kvs::Real32 min_value = m_cell_min_values[index];
+                    const kvs::Real32 max_value = m_cell_max_values[index];
+                    if ( density_map.isEqual( m_density_map, min_value, max_value ) &&
+                         ::IsEqual( color_map, m_color_map, min_value, max_value ) )
                     {
-                        if ( ratio >= ::RandomNumber() )
+                        reused[index] = 1;
+                        for ( size_t e = 0; e < nensembles; e++ )
                         {
-                            sampler.acceptTrial( color_map );
-                            density = density_trial;
-                            counter++;
+                            const kvs::UInt32 n = m_cell_nparticles[ e * ncells + index ];
+                            cell_nparticles[ e * ncells + index ] = n;
+                            slice_nparticles[ e * nslabs + k ] += n;
                         }
-                        else
+                        continue;
+                    }
+                }
+
+                if ( !bricks.isEmpty() )
+                {
+                    const size_t brick_index = bricks.brickIndex( i, j, k );
+                    if ( !active_bricks[ brick_index ] )
+                    {
+                        // The range of the brick, which contains that of the cell,
+                        // is kept for the test of the reuse.
+                        if ( !cached )
                         {
-#ifdef DUPLICATION
-                            sampler.accept( color_map );
-                            counter++;
-#else
-                            if ( ++nduplications > max_loops ) { break; }
-#endif
+                            m_cell_min_values[index] = bricks.minValue( brick_index );
+                            m_cell_max_values[index] = bricks.maxValue( brick_index );
                         }
+                        continue;
                     }
-                } // end of while-loop
-            } // end of i-loop
-        } // end of j-loop
-    } // end of k-loop
-    timer2.stop();
-    delete[] nparticles;
-    std::cout << std::endl << "Particle generation time for loop: " << timer2.sec() - sum << " [sec]" << std::endl;
-    SuperClass::setCoords( sampler.particles().coords() );
-    SuperClass::setColors( sampler.particles().colors() );
-    SuperClass::setNormals( sampler.particles().normals() );
-    SuperClass::setSize( 1.0f );
- 
-}
+                }
 
-void YinYangGridSampling::mapping_metro_yang( const YYZVis::YinYangVolumeObjectBase* volume ) //Yang-grid Metropolis sampling.
-{
-    KVS_ASSERT( volume != NULL );
-    BaseClass::attachVolume( volume );
-    BaseClass::setRange( volume );
-    BaseClass::setMinMaxCoords( volume, this );
+                // The range of the sampled cell is always updated, since the
+                // range of the brick may have been kept for the cell, and the
+                // rejection sampling must use the range of the cell itself.
+                sampler.bind( kvs::Vec3ui( i, j, k ), index );
+                {
+                    kvs::Real32 min_value = grid.value(0);
+                    kvs::Real32 max_value = grid.value(0);
+                    for ( size_t n = 1; n < 8; n++ )
+                    {
+                        min_value = kvs::Math::Min( min_value, grid.value(n) );
+                        max_value = kvs::Math::Max( max_value, grid.value(n) );
+                    }
+                    m_cell_min_values[index] = min_value;
+                    m_cell_max_values[index] = max_value;
+                }
 
-    YYZVis::YinYangGrid grid( volume );
-    YYZVis::DensityMap density_map;
-    density_map.setSubpixelLevel( m_subpixel_level );
-    density_map.setSamplingStep( m_sampling_step );
-    density_map.attachCamera( m_camera );
-    density_map.attachObject( volume );
-    density_map.create( BaseClass::transferFunction().opacityMap() );
+                if ( yang )
+                {
+                    const size_t area = j + ( dim_theta - 1 ) * k;
+                    nexpected[index] = sampler.expectedNumberOfParticles( volume, overlap_weight[ area ] );
+                }
+                else
+                {
+                    nexpected[index] = sampler.expectedNumberOfParticles( volume );
+                }
 
-    ::Sampler sampler( &grid, &density_map );
-    const size_t dim_r = volume->dimR(); // radius
-    const size_t dim_theta = volume->dimTheta(); // latitude
-    const size_t dim_phi = volume->dimPhi(); // longitude
-    const kvs::ColorMap color_map( BaseClass::transferFunction().colorMap() );
-    kvs::Timer timer;
-    kvs::Timer timer2;
+                for ( size_t e = 0; e < nensembles; e++ )
+                {
+                    sampler.setStream( kvs::UInt32( 2 * e ) );
+                    const size_t n = m_sampling_method == Uniform ?
+                        sampler.poissonNumberOfParticles( nexpected[index] ) :
+                        sampler.numberOfParticles( nexpected[index] );
+                    cell_nparticles[ e * ncells + index ] = kvs::UInt32( n );
+                    slice_nparticles[ e * nslabs + k ] += n;
+                }
+            }
+        }
+    }, m_nthreads );
+
+    // Exclusive prefix sum of the numbers of the current particles of the slices.
+    size_t old_offset = 0;
+    for ( size_t slice = 0; slice < old_slice_offsets.size(); slice++ )
+    {
+        const size_t size = old_slice_offsets[ slice ];
+        old_slice_offsets[ slice ] = old_offset;
+        old_offset += size;
+    }
 
-    size_t size = ( dim_phi - 1 ) * ( dim_theta - 1 ) * ( dim_r - 1 );
-    float* nparticles = new float[size];
-    size_t* overlap_flag = new size_t[size];
+    ::ParticleBuffer buffer;
+    buffer.allocate( slice_nparticles );
 
-    timer.start();
-    size_t index = 0;
-    for ( size_t k = 0; k < dim_phi - 1; k++ )
+    Parallel::For( 0, nslabs, [&]( const size_t k )
     {
-        for ( size_t j = 0; j < dim_theta - 1; j++ )
+        YYZVis::YinYangGrid grid( volume );
+        ::Sampler sampler( &grid, &density_map, m_seed );
+        std::vector< ::Particles > slices( nensembles );
+        std::vector<size_t> old_offsets( nensembles, 0 );
+        for ( size_t e = 0; e < nensembles; e++ )
         {
-            for ( size_t i = 0; i < dim_r - 1; i++, index++ )
-            {
-                sampler.bind( kvs::Vec3ui( i, j, k ) );
-                overlap_flag[index] = sampler.checkOverlapFlag( volume );
-                nparticles[index] = sampler.numberOfParticles( volume, overlap_flag[index] );
-            }
+            slices[e] = buffer.slice( e * nslabs + k );
+            if ( cached ) { old_offsets[e] = old_slice_offsets[ e * nslabs + k ]; }
         }
-    }
-    timer.stop();
-//    std::cout << "Calculate number of particles." << timer.sec() << " sec" << std::endl;
-    timer2.start();
-    index = 0;
-    for ( size_t k = 0; k < dim_phi - 1; k++ )
-    {
+
+        size_t index = k * slab_size;
         for ( size_t j = 0; j < dim_theta - 1; j++ )
         {
             for ( size_t i = 0; i < dim_r - 1; i++, index++ )
             {
-                sampler.bind( kvs::Vec3ui( i, j, k ) );
-
-                const size_t max_loops = nparticles[index] * 10;
-                if ( nparticles[index] == 0 ) continue;
-
-                size_t nduplications = 0;
-                size_t counter = 0;
-                size_t sample_stoper = 0;
-                kvs::Real32 density;
-                kvs::Real32 density_trial;
-                kvs::Real32 ratio;
-
-                if( overlap_flag[index] == 0 || overlap_flag[index] == 255 ) // overlap flag == 0.
+                if ( cached )
                 {
-                    density =  sampler.sample( max_loops );
-                    while ( counter < nparticles[index] )
+                    for ( size_t e = 0; e < nensembles; e++ )
                     {
-                        density_trial = sampler.trySample();
-                        ratio = density_trial / density;
-                        if ( ratio >= 1.0f )
+                        const size_t offset = old_offsets[e] * 3;
+                        const size_t n = m_cell_nparticles[ e * ncells + index ];
+                        if ( reused[index] )
                         {
-                            sampler.acceptTrial( color_map );
-                            density = density_trial;
-                            counter++;
-                        }
-                        else
-                        {
-                            if ( ratio >= ::RandomNumber() )
-                            {
-                                sampler.acceptTrial( color_map );
-                                density = density_trial;
-                                counter++;
-                            }
-                            else
-                            {
-#ifdef DUPLICATION
-                                sampler.accept( color_map );
-                                counter++;
-#else
-                                if ( ++nduplications > max_loops ) { break; }
-#endif
-                            }
+                            slices[e].push( old_coords.data() + offset, old_normals.data() + offset, old_colors.data() + offset, n );
                         }
-                    } // end of while-loop
-                } // end if. overlap flag == 0
-
-                else
-                {
-                    //std::cout << "checkflag = " << overlap_flag << std::endl;
-                    sample_stoper = 0;
-                    density =  sampler.sampleOverlap( max_loops, volume, sample_stoper );
-                    if( sample_stoper == 1 ) continue;
-                    while ( counter < nparticles[index] )
-                    {
-                        sample_stoper = 0;
-                        density_trial = sampler.trySampleOverlap( volume, sample_stoper );
-                        if( sample_stoper == 1 ) continue;
-                        ratio = density_trial / density;
-                        if ( ratio >= 1.0f )
-                        {
-                            sampler.acceptTrial( color_map );
-                            density = density_trial;
-                            counter++;
-                        }
-                        else
-                        {
-                            if ( ratio >= ::RandomNumber() )
-                            {
-                                sampler.acceptTrial( color_map );
-                                density = density_trial;
-                                counter++;
-                            }
-                            else
-                            {
-#ifdef DUPLICATION
-                                sampler.accept( color_map );
-                                counter++;
-#else
-                                if ( ++nduplications > max_loops ) { break; }
-#endif
-                            }
-                        }
-                    } // end of while-loop
-                } //end else. 1 <= overlap flag <= 254
-            } // end of i-loop
-        } // end of j-loop
-    } // end of k-loop
-    timer2.stop();
-    delete[] nparticles;
-    delete[] overlap_flag;
-//    std::cout << std::endl << "Particle generation time for loop: " << timer2.sec() << " [sec]" << std::endl;    
-    SuperClass::setCoords( sampler.particles().coords() );
-    SuperClass::setColors( sampler.particles().colors() );
-    SuperClass::setNormals( sampler.particles().normals() );
-    SuperClass::setSize( 1.0f );
-}
-
-void YinYangGridSampling::mapping_uniform( const YYZVis::YinYangVolumeObjectBase* volume )
-{
-    KVS_ASSERT( volume != NULL );
-    BaseClass::attachVolume( volume );
-    BaseClass::setRange( volume );
-    BaseClass::setMinMaxCoords( volume, this );
-
-    YYZVis::YinYangGrid grid( volume );
-    YYZVis::DensityMap density_map;
-    density_map.setSubpixelLevel( m_subpixel_level );
-    density_map.setSamplingStep( m_sampling_step );
-    density_map.attachCamera( m_camera );
-    density_map.attachObject( volume );
-    density_map.create( BaseClass::transferFunction().opacityMap() );
-
-    ::Sampler sampler( &grid, &density_map );
-    const size_t dim_r = volume->dimR(); // radius
-    const size_t dim_theta = volume->dimTheta(); // latitude
-    const size_t dim_phi = volume->dimPhi(); // longitude
-    const kvs::ColorMap color_map( BaseClass::transferFunction().colorMap() );
-    size_t overlap_flag = 0;
-    size_t nparticles = 0;
-    size_t sample_stoper = 0;
-
-    for ( size_t k = 0; k < dim_phi - 1; k++ )
-    {
-        for ( size_t j = 0; j < dim_theta - 1; j++ )
-        {
-            for ( size_t i = 0; i < dim_r - 1; i++ )
-            {
-                sampler.bind( kvs::Vec3ui( i, j, k ) );
-
-                overlap_flag = sampler.checkOverlapFlag( volume );
+                        old_offsets[e] += n;
+                    }
+                    if ( reused[index] ) continue;
+                }
 
-                nparticles = sampler.numberOfParticles( volume );
-                if ( nparticles == 0 ) continue;
+                if ( nexpected[index] == 0.0f ) continue;
+                sampler.bind( kvs::Vec3ui( i, j, k ), index );
 
-                for ( size_t i = 0; i < nparticles; ++i )
+                // The max. density in the value range of the cell bounds the
+                // densities in the cell for the rejection sampling.
+                const bool uniform = m_sampling_method == Uniform;
+                const bool rejection = m_sampling_method == Rejection;
+                const kvs::Real32 max_density = rejection ?
+                    density_map.maxDensity( m_cell_min_values[index], m_cell_max_values[index] ) : 0.0f;
+                for ( size_t e = 0; e < nensembles; e++ )
                 {
-                    if( overlap_flag == 0 || overlap_flag == 255 || volume->gridType() == volume->gridYin() )
+                    kvs::UInt32& n = cell_nparticles[ e * ncells + index ];
+                    if ( n == 0 ) continue;
+
+                    const size_t size = slices[e].size();
+                    sampler.setStream( kvs::UInt32( 2 * e + 1 ) );
+                    sampler.attachParticles( &slices[e] );
+                    const kvs::UInt8 flag = yang ? overlap_flag[ j + ( dim_theta - 1 ) * k ] : 0;
+                    if( flag == 0 || flag == 255 ) // overlap flag == 0.
                     {
-                        sampler.sample();
-                        sampler.accept( color_map );
+                        if ( uniform ) { sampler.uniform( n, color_map ); }
+                        else if ( rejection ) { sampler.rejection( n, max_density, color_map ); }
+                        else { sampler.metropolis( n, color_map ); }
                     }
-                    else //1 <=  flag <= 254
+                    else // 1 <= overlap flag <= 254
                     {
-                        sample_stoper = 0;
-                        sampler.sampleOverlap( volume, sample_stoper );
-                        if( sample_stoper == 1 ) continue;
-                        sampler.accept( color_map );
+                        if ( uniform ) { sampler.uniformOverlap( n, volume, color_map ); }
+                        else if ( rejection ) { sampler.rejectionOverlap( n, volume, max_density, color_map ); }
+                        else { sampler.metropolisOverlap( n, volume, color_map ); }
                     }
+
+                    // The number of the particles actually generated in the cell.
+                    n = kvs::UInt32( slices[e].size() - size );
                 }
-            }
-        }
-    }
+            } // end of i-loop
+        } // end of j-loop
+
+        for ( size_t e = 0; e < nensembles; e++ ) { buffer.setSize( e * nslabs + k, slices[e].size() ); }
+    }, m_nthreads ); // end of k-loop
 
-    SuperClass::setCoords( sampler.particles().coords() );
-    SuperClass::setColors( sampler.particles().colors() );
-    SuperClass::setNormals( sampler.particles().normals() );
+    buffer.compact();
+    timer2.stop();
+//    std::cout << std::endl << "Particle generation time for loop: " << timer2.sec() << " [sec]" << std::endl;
+    this->set_ensemble_offsets( buffer.sizes(), nslabs );
+    SuperClass::setCoords( buffer.coords() );
+    SuperClass::setColors( buffer.colors() );
+    SuperClass::setNormals( buffer.normals() );
     SuperClass::setSize( 1.0f );
+
+    m_density_map = density_map;
+    m_color_map = color_map;
+    m_cell_nparticles.swap( cell_nparticles );
 }
 
 } // end of namespace YYZVis
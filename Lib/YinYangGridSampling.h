@@ -4,7 +4,11 @@
 #include <kvs/PointObject>
 #include <kvs/VolumeObjectBase>
 #include <kvs/Module>
+#include <kvs/ColorMap>
+#include <kvs/TransferFunction>
+#include <vector>
 #include "YinYangVolumeObjectBase.h"
+#include "DensityMap.h"
 
 
 namespace YYZVis
@@ -13,6 +17,18 @@ namespace YYZVis
 /*===========================================================================*/
 /**
  *  @brief  Partilce generation class for Yin-Yang grid.
+ *
+ *  With setNumberOfEnsembles(R), R statistically independent particle sets
+ *  are generated in a single traversal of the cells and stored one after
+ *  another; the member e is in [ensembleOffset(e), ensembleOffset(e+1)).
+ *  Rendering all of them with the repetition level R is equivalent to
+ *  rendering a single set generated with R times the particle density.
+ *
+ *  The particles in a cell are generated by the Metropolis method (default),
+ *  or by the rejection method using the max. density in the value range of
+ *  the cell, which generates independent particles without burn-in. The
+ *  uniform method, which is the fastest and suited for the preview, places
+ *  a Poisson distributed number of particles uniformly in each cell.
  */
 /*===========================================================================*/
 class YinYangGridSampling : public kvs::MapperBase, public kvs::PointObject
@@ -21,13 +37,32 @@ class YinYangGridSampling : public kvs::MapperBase, public kvs::PointObject
     kvsModuleBaseClass( kvs::MapperBase );
     kvsModuleSuperClass( kvs::PointObject );
 
+public:
+    enum SamplingMethod
+    {
+        Metropolis, ///< Metropolis sampling
+        Rejection, ///< rejection sampling with the max. density of the cell
+        Uniform ///< uniform sampling
+    };
+
 private:
     const kvs::Camera* m_camera; ///< camera (reference)
     size_t m_subpixel_level; ///< subpixel level
     float m_sampling_step; ///< sampling step in the object coordinate
     float m_object_depth; ///< object depth
+    size_t m_nthreads; ///< number of threads (0: number of hardware threads)
+    kvs::UInt32 m_seed; ///< seed of the random numbers
+    size_t m_nensembles; ///< number of ensemble members
+    SamplingMethod m_sampling_method; ///< sampling method
+    std::vector<size_t> m_ensemble_offsets; ///< first particle of each ensemble member
+    YYZVis::DensityMap m_density_map; ///< density map used for the current particles
+    kvs::ColorMap m_color_map; ///< color map used for the current particles
+    std::vector<kvs::Real32> m_cell_min_values; ///< min. value of each cell
+    std::vector<kvs::Real32> m_cell_max_values; ///< max. value of each cell
+    std::vector<kvs::UInt32> m_cell_nparticles; ///< number of particles of each cell (member-major)
 
 public:
+    YinYangGridSampling();
     YinYangGridSampling(
         const kvs::VolumeObjectBase* volume,
         const size_t subpixel_level,
@@ -44,20 +79,35 @@ public:
         const float object_depth = 0.0f );
 
     SuperClass* exec( const kvs::ObjectBase* object );
+    SuperClass* resample( const kvs::TransferFunction& transfer_function );
 
     size_t subpixelLevel() const { return m_subpixel_level; }
     float samplingStep() const { return m_sampling_step; }
     float objectDepth() const { return m_object_depth; }
+    size_t numberOfThreads() const { return m_nthreads; }
+    kvs::UInt32 seed() const { return m_seed; }
+    size_t numberOfEnsembles() const { return m_nensembles; }
+    SamplingMethod samplingMethod() const { return m_sampling_method; }
+    size_t ensembleOffset( const size_t index ) const { return m_ensemble_offsets[ index ]; }
+    size_t ensembleSize( const size_t index ) const { return m_ensemble_offsets[ index + 1 ] - m_ensemble_offsets[ index ]; }
+    kvs::PointObject* newEnsemble( const size_t index ) const;
 
     void attachCamera( const kvs::Camera* camera ) { m_camera = camera; }
     void setSubpixelLevel( const size_t subpixel_level ) { m_subpixel_level = subpixel_level; }
     void setSamplingStep( const float step ) { m_sampling_step = step; }
     void setObjectDepth( const float depth ) { m_object_depth = depth; }
+    void setNumberOfThreads( const size_t nthreads ) { m_nthreads = nthreads; }
+    void setSeed( const kvs::UInt32 seed ) { m_seed = seed; m_cell_nparticles.clear(); }
+    void setNumberOfEnsembles( const size_t nensembles ) { m_nensembles = nensembles > 0 ? nensembles : 1; }
+    void setSamplingMethod( const SamplingMethod method ) { m_sampling_method = method; m_cell_nparticles.clear(); }
+    void setSamplingMethodToMetropolis() { this->setSamplingMethod( Metropolis ); }
+    void setSamplingMethodToRejection() { this->setSamplingMethod( Rejection ); }
+    void setSamplingMethodToUniform() { this->setSamplingMethod( Uniform ); }
 
 private:
-    void mapping_metro_yin( const YYZVis::YinYangVolumeObjectBase* volume );
-    void mapping_metro_yang( const YYZVis::YinYangVolumeObjectBase* volume );
-    void mapping_uniform( const YYZVis::YinYangVolumeObjectBase* volume );
+    SuperClass* mapping( const kvs::ObjectBase* object, const bool reuse );
+    void mapping_cells( const YYZVis::YinYangVolumeObjectBase* volume, const bool reuse );
+    void set_ensemble_offsets( const std::vector<size_t>& sizes, const size_t nslices );
 };
 
 } // end of namespace YYZVis
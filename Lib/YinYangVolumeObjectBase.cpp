@@ -1,6 +1,9 @@
 #include "YinYangVolumeObjectBase.h"
+#include "Parallel.h"
 #include <kvs/Endian>
+#include <kvs/Math>
 #include <fstream>
+#include <cmath>
 
 
 namespace
@@ -11,46 +14,93 @@ const std::string GridTypeName[2] = {
     "yang"
 };
 
-kvs::ValueArray<kvs::Real32> CalculateCoords( const YYZVis::YinYangVolumeObjectBase* object )
+/*===========================================================================*/
+/**
+ *  @brief  Calculates node coordinates for the given grid type.
+ *  @param  object [in] pointer to the yin/yang volume object
+ *  @param  coords [out] pointer to the coordinate array (nnodes * 3)
+ *
+ *  The node coordinates are calculated from the separable r/theta/phi tables
+ *  of the object, and the slabs of constant phi are filled in parallel. The
+ *  yin/yang axis permutation is resolved at compile time.
+ */
+/*===========================================================================*/
+template <YYZVis::YinYangVolumeObjectBase::GridType GridType>
+inline void CalculateCoords( const YYZVis::YinYangVolumeObjectBase* object, kvs::Real32* coords )
 {
     const size_t dim_r = object->dimR(); // radius
     const size_t dim_theta = object->dimTheta(); // latitude
     const size_t dim_phi = object->dimPhi(); // longitude
 
-    const YYZVis::YinYangVolumeObjectBase::Range range_r = object->rangeR();
-    const YYZVis::YinYangVolumeObjectBase::Range range_theta = object->rangeTheta();
-    const YYZVis::YinYangVolumeObjectBase::Range range_phi = object->rangePhi();
+    const kvs::Real32* const r_table = object->rTable().data();
+    const kvs::Real32* const sin_theta_table = object->sinThetaTable().data();
+    const kvs::Real32* const cos_theta_table = object->cosThetaTable().data();
+    const kvs::Real32* const sin_phi_table = object->sinPhiTable().data();
+    const kvs::Real32* const cos_phi_table = object->cosPhiTable().data();
 
-    const size_t nnodes = object->numberOfNodes();
-    kvs::ValueArray<kvs::Real32> coords( nnodes * 3 );
-    kvs::Real32* pcoords = coords.data();
-    for ( int k = 0; k < (int)dim_phi; k++ )
+    YYZVis::Parallel::For( 0, dim_phi, [&]( const size_t k )
     {
-        const float phi = range_phi.min + range_phi.d * ( k - 2 );
-        const float sin_phi = std::sin( phi );
-        const float cos_phi = std::cos( phi );
-        for ( int j = 0; j < (int)dim_theta; j++ )
+        const float sin_phi = sin_phi_table[k];
+        const float cos_phi = cos_phi_table[k];
+        kvs::Real32* pcoords = coords + 3 * dim_r * dim_theta * k;
+        for ( size_t j = 0; j < dim_theta; j++ )
         {
-            const float theta = range_theta.min + range_theta.d * ( j - 1 );
-            const float sin_theta = std::sin( theta );
-            const float cos_theta = std::cos( theta );
-            for ( int i = 0; i < (int)dim_r; i++ )
+            const float sin_theta = sin_theta_table[j];
+            const float cos_theta = cos_theta_table[j];
+            for ( size_t i = 0; i < dim_r; i++ )
             {
-                const float r = range_r.min + range_r.d * i;
+                const float r = r_table[i];
                 const float x = r * sin_theta * cos_phi;
                 const float y = r * sin_theta * sin_phi;
                 const float z = r * cos_theta;
-
-                *(pcoords++) = ( object->gridType() == YYZVis::YinYangVolumeObjectBase::Yin ) ? x : -x;
-                *(pcoords++) = ( object->gridType() == YYZVis::YinYangVolumeObjectBase::Yin ) ? y : z;
-                *(pcoords++) = ( object->gridType() == YYZVis::YinYangVolumeObjectBase::Yin ) ? z : y;
+                if ( GridType == YYZVis::YinYangVolumeObjectBase::Yin )
+                {
+                    *(pcoords++) = x;
+                    *(pcoords++) = y;
+                    *(pcoords++) = z;
+                }
+                else
+                {
+                    *(pcoords++) = -x;
+                    *(pcoords++) = z;
+                    *(pcoords++) = y;
+                }
             }
         }
+    } );
+}
+
+kvs::ValueArray<kvs::Real32> CalculateCoords( const YYZVis::YinYangVolumeObjectBase* object )
+{
+    const size_t nnodes = object->numberOfNodes();
+    kvs::ValueArray<kvs::Real32> coords( nnodes * 3 );
+    if ( object->gridType() == YYZVis::YinYangVolumeObjectBase::Yin )
+    {
+        CalculateCoords<YYZVis::YinYangVolumeObjectBase::Yin>( object, coords.data() );
+    }
+    else
+    {
+        CalculateCoords<YYZVis::YinYangVolumeObjectBase::Yang>( object, coords.data() );
     }
 
     return coords;
 }
 
+/*===========================================================================*/
+/**
+ *  @brief  Returns the node coordinates of the object.
+ *  @param  object [in] pointer to the yin/yang volume object
+ *  @return coordinate array
+ *
+ *  If the coordinates are not materialized, they are calculated from the
+ *  r/theta/phi tables.
+ */
+/*===========================================================================*/
+kvs::ValueArray<kvs::Real32> GridCoords( const YYZVis::YinYangVolumeObjectBase* object )
+{
+    return object->hasCoords() ? object->coords() : CalculateCoords( object );
+}
+
 kvs::ValueArray<kvs::UInt32> CalculateConnections( const YYZVis::YinYangVolumeObjectBase* object )
 {
     const size_t dim_r = object->dimR(); // radius
@@ -93,7 +143,7 @@ kvs::StructuredVolumeObject* YinYangVolumeObjectBase::ToStructuredVolumeObject(
     volume->setGridTypeToCurvilinear();
     volume->setVeclen( object->veclen() );
     volume->setResolution( kvs::Vec3ui( object->dimR(), object->dimTheta(), object->dimPhi() ) );
-    volume->setCoords( object->coords().size() == 0 ? ::CalculateCoords( object ) : object->coords() );
+    volume->setCoords( ::GridCoords( object ) );
     volume->setValues( object->values() );
     volume->setMinMaxValues( object->minValue(), object->maxValue() );
     volume->setMinMaxObjectCoords( object->minObjectCoord(), object->maxObjectCoord() );
@@ -111,7 +161,7 @@ kvs::UnstructuredVolumeObject* YinYangVolumeObjectBase::ToUnstructuredVolumeObje
     volume->setVeclen( object->veclen() );
     volume->setNumberOfNodes( object->numberOfNodes() );
     volume->setNumberOfCells( object->numberOfCells() );
-    volume->setCoords( object->coords().size() == 0 ? ::CalculateCoords( object ) : object->coords() );
+    volume->setCoords( ::GridCoords( object ) );
     volume->setConnections( ::CalculateConnections( object ) );
     volume->setValues( object->values() );
     volume->setMinMaxValues( object->minValue(), object->maxValue() );
@@ -154,6 +204,15 @@ void YinYangVolumeObjectBase::shallowCopy( const YinYangVolumeObjectBase& object
     m_range_r = object.m_range_r;
     m_range_theta = object.m_range_theta;
     m_range_phi = object.m_range_phi;
+    m_r_table = object.m_r_table;
+    m_sin_theta_table = object.m_sin_theta_table;
+    m_cos_theta_table = object.m_cos_theta_table;
+    m_sin_phi_table = object.m_sin_phi_table;
+    m_cos_phi_table = object.m_cos_phi_table;
+    m_cell_volume_r_table = object.m_cell_volume_r_table;
+    m_cell_volume_theta_table = object.m_cell_volume_theta_table;
+    m_brick_min_max = object.m_brick_min_max;
+    m_span_space_index = object.m_span_space_index;
 }
 
 void YinYangVolumeObjectBase::deepCopy( const YinYangVolumeObjectBase& object )
@@ -166,6 +225,15 @@ void YinYangVolumeObjectBase::deepCopy( const YinYangVolumeObjectBase& object )
     m_range_r = object.m_range_r;
     m_range_theta = object.m_range_theta;
     m_range_phi = object.m_range_phi;
+    m_r_table = object.m_r_table;
+    m_sin_theta_table = object.m_sin_theta_table;
+    m_cos_theta_table = object.m_cos_theta_table;
+    m_sin_phi_table = object.m_sin_phi_table;
+    m_cos_phi_table = object.m_cos_phi_table;
+    m_cell_volume_r_table = object.m_cell_volume_r_table;
+    m_cell_volume_theta_table = object.m_cell_volume_theta_table;
+    m_brick_min_max = object.m_brick_min_max;
+    m_span_space_index = object.m_span_space_index;
 }
 
 void YinYangVolumeObjectBase::print( std::ostream& os, const kvs::Indent& indent ) const
@@ -193,6 +261,20 @@ void YinYangVolumeObjectBase::setDimR( const size_t dim_r, const float range_min
     m_range_r.max = range_max;
     m_range_r.min = range_min;
     m_range_r.d = ( m_range_r.max - m_range_r.min ) / ( m_dim_r - 1 );
+
+    m_r_table.allocate( m_dim_r );
+    for ( int i = 0; i < (int)m_dim_r; i++ )
+    {
+        m_r_table[i] = m_range_r.min + m_range_r.d * i;
+    }
+
+    m_cell_volume_r_table.allocate( m_dim_r - 1 );
+    for ( int i = 0; i < (int)m_dim_r - 1; i++ )
+    {
+        const double r0 = double( m_range_r.min ) + double( m_range_r.d ) * i;
+        const double r1 = r0 + double( m_range_r.d );
+        m_cell_volume_r_table[i] = kvs::Real32( ( r1 * r1 * r1 - r0 * r0 * r0 ) / 3.0 );
+    }
 }
 
 void YinYangVolumeObjectBase::setDimTheta( const size_t dim_theta, const size_t overwrap )
@@ -205,6 +287,25 @@ void YinYangVolumeObjectBase::setDimTheta( const size_t dim_theta, const size_t
     m_range_theta.max = pi - pi / 4.0f;
     m_range_theta.min = pi / 4.0f;
     m_range_theta.d = ( m_range_theta.max - m_range_theta.min ) / ( m_dim_theta - overwrap - 1 );
+
+    m_sin_theta_table.allocate( m_dim_theta );
+    m_cos_theta_table.allocate( m_dim_theta );
+    for ( int j = 0; j < (int)m_dim_theta; j++ )
+    {
+        const float theta = m_range_theta.min + m_range_theta.d * ( j - 1 );
+        m_sin_theta_table[j] = std::sin( theta );
+        m_cos_theta_table[j] = std::cos( theta );
+    }
+
+    // cos(theta0) - cos(theta1) = 2 sin((theta0 + theta1) / 2) sin(dtheta / 2),
+    // which avoids the cancellation of the nearly equal cosines.
+    m_cell_volume_theta_table.allocate( m_dim_theta - 1 );
+    for ( int j = 0; j < (int)m_dim_theta - 1; j++ )
+    {
+        const double d = m_range_theta.d;
+        const double theta = double( m_range_theta.min ) + d * ( j - 1 ) + d * 0.5;
+        m_cell_volume_theta_table[j] = kvs::Real32( 2.0 * std::sin( theta ) * std::sin( d * 0.5 ) );
+    }
 }
 
 void YinYangVolumeObjectBase::setDimPhi( const size_t dim_phi, const size_t overwrap )
@@ -217,6 +318,33 @@ void YinYangVolumeObjectBase::setDimPhi( const size_t dim_phi, const size_t over
     m_range_phi.max = ( 3 * pi ) / 4.0f;
     m_range_phi.min = -( 3 * pi ) / 4.0f;
     m_range_phi.d = ( m_range_phi.max - m_range_phi.min ) / ( m_dim_phi - overwrap - 1 );
+
+    m_sin_phi_table.allocate( m_dim_phi );
+    m_cos_phi_table.allocate( m_dim_phi );
+    for ( int k = 0; k < (int)m_dim_phi; k++ )
+    {
+        const float phi = m_range_phi.min + m_range_phi.d * ( k - 2 );
+        m_sin_phi_table[k] = std::sin( phi );
+        m_cos_phi_table[k] = std::cos( phi );
+    }
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Sets the grid type.
+ *  @param  grid_type [in] grid type
+ *
+ *  The materialized coordinates of the other grid type are released, since
+ *  they are expressed in the frame of that grid.
+ */
+/*===========================================================================*/
+void YinYangVolumeObjectBase::setGridType( const GridType grid_type )
+{
+    if ( m_grid_type != grid_type && this->hasCoords() )
+    {
+        this->setCoords( kvs::ValueArray<kvs::Real32>() );
+    }
+    m_grid_type = grid_type;
 }
 
 size_t YinYangVolumeObjectBase::numberOfNodes() const
@@ -234,6 +362,46 @@ void YinYangVolumeObjectBase::calculateCoords()
     this->setCoords( ::CalculateCoords( this ) );
 }
 
+/*===========================================================================*/
+/**
+ *  @brief  Shares the geometry tables with the given yin/yang volume object.
+ *  @param  object [in] yin/yang volume object with the same dimensions
+ *
+ *  The r/theta/phi tables of the given object are referenced instead of being
+ *  allocated again. They are the same for the yin and yang grids, since the
+ *  yang grid is the yin grid rotated by (x,y,z) -> (-x,z,y), and coord()
+ *  applies the rotation of this grid. Since the coordinates are calculated
+ *  from the tables, no coordinate array is shared; the one of the given object
+ *  is referenced only if it has the same grid type. If the dimensions differ,
+ *  nothing is shared and this object keeps its own tables.
+ */
+/*===========================================================================*/
+void YinYangVolumeObjectBase::shareGeometry( const YinYangVolumeObjectBase& object )
+{
+    const bool same_dims =
+        m_dim_r == object.dimR() &&
+        m_dim_theta == object.dimTheta() &&
+        m_dim_phi == object.dimPhi() &&
+        m_range_r.min == object.rangeR().min &&
+        m_range_r.max == object.rangeR().max;
+    if ( !same_dims )
+    {
+        kvsMessageError() << "Cannot share the geometry of the volume with different dimensions." << std::endl;
+        return;
+    }
+
+    m_r_table = object.rTable();
+    m_sin_theta_table = object.sinThetaTable();
+    m_cos_theta_table = object.cosThetaTable();
+    m_sin_phi_table = object.sinPhiTable();
+    m_cos_phi_table = object.cosPhiTable();
+    m_cell_volume_r_table = object.cellVolumeRTable();
+    m_cell_volume_theta_table = object.cellVolumeThetaTable();
+
+    const bool same_frame = object.hasCoords() && m_grid_type == object.gridType();
+    this->setCoords( same_frame ? object.coords() : kvs::ValueArray<kvs::Real32>() );
+}
+
 bool YinYangVolumeObjectBase::readValues( const std::string& filename )
 {
     const size_t nnodes = this->numberOfNodes();
@@ -248,38 +416,37 @@ bool YinYangVolumeObjectBase::readValues( const std::string& filename )
     kvs::Endian::Swap( values.data(), nnodes * veclen );
 
     this->setValues( kvs::AnyValueArray( values ) );
+    m_brick_min_max.release();
+    m_span_space_index.release();
 
     return true;
 }
 
 void YinYangVolumeObjectBase::updateMinMaxCoords()
 {
-    kvs::Vec3 min_coord( 0.0f, 0.0f, 0.0f );
-    kvs::Vec3 max_coord( 0.0f, 0.0f, 0.0f );
-
-    const float* coord = this->coords().data();
-    const float* const end = coord + this->coords().size();
-
-    float x = *( coord++ );
-    float y = *( coord++ );
-    float z = *( coord++ );
-
-    min_coord.set( x, y, z );
-    max_coord.set( x, y, z );
-
-    while ( coord < end )
+    // Each coordinate component is r times a function of (theta, phi), so the
+    // extrema are found on the inner and outer spherical surfaces and the
+    // coordinate array is not needed.
+    const size_t i0 = 0;
+    const size_t i1 = m_dim_r - 1;
+
+    kvs::Vec3 min_coord = this->coord( i0, 0, 0 );
+    kvs::Vec3 max_coord = min_coord;
+    for ( size_t k = 0; k < m_dim_phi; k++ )
     {
-        x = *( coord++ );
-        y = *( coord++ );
-        z = *( coord++ );
+        for ( size_t j = 0; j < m_dim_theta; j++ )
+        {
+            const kvs::Vec3 p0 = this->coord( i0, j, k );
+            const kvs::Vec3 p1 = this->coord( i1, j, k );
 
-        min_coord.x() = kvs::Math::Min( min_coord.x(), x );
-        min_coord.y() = kvs::Math::Min( min_coord.y(), y );
-        min_coord.z() = kvs::Math::Min( min_coord.z(), z );
+            min_coord.x() = kvs::Math::Min( min_coord.x(), p0.x(), p1.x() );
+            min_coord.y() = kvs::Math::Min( min_coord.y(), p0.y(), p1.y() );
+            min_coord.z() = kvs::Math::Min( min_coord.z(), p0.z(), p1.z() );
 
-        max_coord.x() = kvs::Math::Max( max_coord.x(), x );
-        max_coord.y() = kvs::Math::Max( max_coord.y(), y );
-        max_coord.z() = kvs::Math::Max( max_coord.z(), z );
+            max_coord.x() = kvs::Math::Max( max_coord.x(), p0.x(), p1.x() );
+            max_coord.y() = kvs::Math::Max( max_coord.y(), p0.y(), p1.y() );
+            max_coord.z() = kvs::Math::Max( max_coord.z(), p0.z(), p1.z() );
+        }
     }
 
     this->setMinMaxObjectCoords( min_coord, max_coord );
@@ -292,4 +459,35 @@ void YinYangVolumeObjectBase::updateMinMaxCoords()
     }
 }
 
+/*===========================================================================*/
+/**
+ *  @brief  Updates the min/max values of the bricks of the cells.
+ *  @param  brick_size [in] number of cells along each axis of a brick
+ *
+ *  The min/max values should be updated again when the values are changed.
+ */
+/*===========================================================================*/
+void YinYangVolumeObjectBase::updateBrickMinMax( const size_t brick_size )
+{
+    if ( this->veclen() != 1 ) { m_brick_min_max.release(); return; }
+    const kvs::Vec3ui resolution( m_dim_r, m_dim_theta, m_dim_phi );
+    m_brick_min_max.create( BaseClass::values(), resolution, brick_size );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Updates the span space index of the cells.
+ *  @param  nbuckets [in] number of buckets of the min. values of the cells
+ *
+ *  The index is optional, and should be updated again when the values are
+ *  changed. It pays off when many isosurfaces are extracted from the volume.
+ */
+/*===========================================================================*/
+void YinYangVolumeObjectBase::updateSpanSpaceIndex( const size_t nbuckets )
+{
+    if ( this->veclen() != 1 ) { m_span_space_index.release(); return; }
+    const kvs::Vec3ui resolution( m_dim_r, m_dim_theta, m_dim_phi );
+    m_span_space_index.create( BaseClass::values(), resolution, nbuckets );
+}
+
 } // end of namespace YYZVis
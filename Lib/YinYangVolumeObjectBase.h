@@ -4,6 +4,8 @@
 #include <kvs/VolumeObjectBase>
 #include <kvs/StructuredVolumeObject>
 #include <kvs/UnstructuredVolumeObject>
+#include "BrickMinMax.h"
+#include "SpanSpaceIndex.h"
 
 
 namespace YYZVis
@@ -45,6 +47,15 @@ private:
     Range m_range_r; ///< range of radius
     Range m_range_theta; ///< range of latitude
     Range m_range_phi; ///< range of longitude
+    kvs::ValueArray<kvs::Real32> m_r_table; ///< radius at each node along r
+    kvs::ValueArray<kvs::Real32> m_sin_theta_table; ///< sin(theta) at each node along theta
+    kvs::ValueArray<kvs::Real32> m_cos_theta_table; ///< cos(theta) at each node along theta
+    kvs::ValueArray<kvs::Real32> m_sin_phi_table; ///< sin(phi) at each node along phi
+    kvs::ValueArray<kvs::Real32> m_cos_phi_table; ///< cos(phi) at each node along phi
+    kvs::ValueArray<kvs::Real32> m_cell_volume_r_table; ///< (r1^3 - r0^3) / 3 of each cell along r
+    kvs::ValueArray<kvs::Real32> m_cell_volume_theta_table; ///< cos(theta0) - cos(theta1) of each cell along theta
+    YYZVis::BrickMinMax m_brick_min_max; ///< min/max values of the bricks of the cells
+    YYZVis::SpanSpaceIndex m_span_space_index; ///< span space index of the cells (optional)
 
 public:
     YinYangVolumeObjectBase();
@@ -54,7 +65,7 @@ public:
     void deepCopy( const YinYangVolumeObjectBase& object );
     void print( std::ostream& os, const kvs::Indent& indent = kvs::Indent(0) ) const;
 
-    void setGridType( const GridType grid_type ) { m_grid_type = grid_type; }
+    void setGridType( const GridType grid_type );
     void setGridTypeToYin() { this->setGridType( Yin ); }
     void setGridTypeToYang() { this->setGridType( Yang ); }
 
@@ -72,11 +83,99 @@ public:
     Range rangeTheta() const { return m_range_theta; }
     Range rangePhi() const { return m_range_phi; }
 
+    const kvs::ValueArray<kvs::Real32>& rTable() const { return m_r_table; }
+    const kvs::ValueArray<kvs::Real32>& sinThetaTable() const { return m_sin_theta_table; }
+    const kvs::ValueArray<kvs::Real32>& cosThetaTable() const { return m_cos_theta_table; }
+    const kvs::ValueArray<kvs::Real32>& sinPhiTable() const { return m_sin_phi_table; }
+    const kvs::ValueArray<kvs::Real32>& cosPhiTable() const { return m_cos_phi_table; }
+    const kvs::ValueArray<kvs::Real32>& cellVolumeRTable() const { return m_cell_volume_r_table; }
+    const kvs::ValueArray<kvs::Real32>& cellVolumeThetaTable() const { return m_cell_volume_theta_table; }
+    const YYZVis::BrickMinMax& brickMinMax() const { return m_brick_min_max; }
+    const YYZVis::SpanSpaceIndex& spanSpaceIndex() const { return m_span_space_index; }
+
     size_t numberOfNodes() const;
     size_t numberOfCells() const;
+    bool hasCoords() const { return BaseClass::coords().size() != 0; }
+    const kvs::Vec3 coord( const size_t i, const size_t j, const size_t k ) const;
+    const kvs::Vec3 coord( const size_t index ) const;
+    const kvs::Real32 cellVolume( const size_t i, const size_t j, const size_t k ) const;
+    const kvs::Real32 cellVolume( const size_t index ) const;
     void calculateCoords();
+    void shareGeometry( const YinYangVolumeObjectBase& object );
     bool readValues( const std::string& filename );
     void updateMinMaxCoords();
+    void updateBrickMinMax( const size_t brick_size = YYZVis::BrickMinMax::DefaultBrickSize );
+    void updateSpanSpaceIndex( const size_t nbuckets = YYZVis::SpanSpaceIndex::DefaultNumberOfBuckets );
 };
 
+/*===========================================================================*/
+/**
+ *  @brief  Returns the coordinate of the node (i,j,k).
+ *  @param  i [in] node index along r
+ *  @param  j [in] node index along theta
+ *  @param  k [in] node index along phi
+ *  @return coordinate calculated from the separable r/theta/phi tables
+ *
+ *  The coordinate array does not need to be materialized.
+ */
+/*===========================================================================*/
+inline const kvs::Vec3 YinYangVolumeObjectBase::coord( const size_t i, const size_t j, const size_t k ) const
+{
+    const kvs::Real32 r = m_r_table[i];
+    const kvs::Real32 x = r * m_sin_theta_table[j] * m_cos_phi_table[k];
+    const kvs::Real32 y = r * m_sin_theta_table[j] * m_sin_phi_table[k];
+    const kvs::Real32 z = r * m_cos_theta_table[j];
+    return ( m_grid_type == Yin ) ?
+        kvs::Vec3(  x, y, z ) : // Yin
+        kvs::Vec3( -x, z, y ); // Yang = rotated yin
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns the coordinate of the node.
+ *  @param  index [in] node index
+ *  @return coordinate calculated from the separable r/theta/phi tables
+ */
+/*===========================================================================*/
+inline const kvs::Vec3 YinYangVolumeObjectBase::coord( const size_t index ) const
+{
+    const size_t i = index % m_dim_r;
+    const size_t j = ( index / m_dim_r ) % m_dim_theta;
+    const size_t k = index / ( m_dim_r * m_dim_theta );
+    return this->coord( i, j, k );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns the volume of the cell (i,j,k).
+ *  @param  i [in] base node index along r
+ *  @param  j [in] base node index along theta
+ *  @param  k [in] base node index along phi
+ *  @return volume of the spherical shell element of the cell
+ *
+ *  The volume (r1^3 - r0^3)/3 * (cos(theta0) - cos(theta1)) * dphi is
+ *  separable, so it is obtained from the r/theta factor tables and does not
+ *  depend on k. The yang cells have the same volumes as the yin cells.
+ */
+/*===========================================================================*/
+inline const kvs::Real32 YinYangVolumeObjectBase::cellVolume( const size_t i, const size_t j, const size_t /*k*/ ) const
+{
+    return m_cell_volume_r_table[i] * m_cell_volume_theta_table[j] * m_range_phi.d;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns the volume of the cell.
+ *  @param  index [in] node index of the base node of the cell
+ *  @return volume of the spherical shell element of the cell
+ */
+/*===========================================================================*/
+inline const kvs::Real32 YinYangVolumeObjectBase::cellVolume( const size_t index ) const
+{
+    const size_t i = index % m_dim_r;
+    const size_t j = ( index / m_dim_r ) % m_dim_theta;
+    const size_t k = index / ( m_dim_r * m_dim_theta );
+    return this->cellVolume( i, j, k );
+}
+
 } // end of namespace YYZVis
@@ -0,0 +1,186 @@
+#include "YinYangZhongImporter.h"
+#include "Parallel.h"
+#include <kvs/Json>
+#include <kvs/File>
+#include <iostream>
+#include <atomic>
+
+
+namespace
+{
+
+/*===========================================================================*/
+/**
+ *  @brief  Data file to be read.
+ */
+/*===========================================================================*/
+struct DataFile
+{
+    size_t volume; ///< volume index (0: yin, 1: yang, 2: zhong)
+    size_t component; ///< component index
+    std::string filename; ///< filename
+};
+
+} // end of namespace
+
+
+namespace YYZVis
+{
+
+/*===========================================================================*/
+/**
+ *  @brief  Constructs a new YinYangZhongImporter class.
+ *  @param  filename [in] filename of the JSON descriptor
+ *  @param  nthreads [in] max. number of threads (0: number of hardware threads)
+ */
+/*===========================================================================*/
+YinYangZhongImporter::YinYangZhongImporter( const std::string& filename, const size_t nthreads ):
+    m_number_of_threads( nthreads )
+{
+    kvs::Json json( filename );
+    this->exec( &json );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Executes the importing process.
+ *  @param  file_format [in] pointer to the data file
+ *  @return pointer to the imported volume objects
+ */
+/*===========================================================================*/
+YinYangZhongImporter::SuperClass* YinYangZhongImporter::exec( const kvs::FileFormatBase* file_format )
+{
+    if ( !file_format )
+    {
+        BaseClass::setSuccess( false );
+        kvsMessageError() << "Input file is NULL." << std::endl;
+        return NULL;
+    }
+
+    if ( !dynamic_cast<const kvs::Json*>( file_format ) )
+    {
+        BaseClass::setSuccess( false );
+        kvsMessageError() << "Input file is not JSON file." << std::endl;
+        return NULL;
+    }
+
+    kvs::Json* json = (kvs::Json*)( file_format );
+    auto& object = json->rootObject();
+
+    const size_t dim_rad( object["dim_rad"].get<double>() );
+    const size_t dim_lat( object["dim_lat"].get<double>() );
+    const size_t dim_lon( object["dim_lon"].get<double>() );
+    const size_t dim_zhong( object["dim_zhong"].get<double>() );
+    const std::string endian( object["endian"].get<std::string>() );
+
+    // List of the data files for the yin, yang and zhong volumes.
+    const std::string path_name = kvs::File( json->filename() ).pathName( true );
+    const std::string keys[3] = { "yin_value", "yang_value", "zhong_value" };
+    std::vector<::DataFile> files;
+    size_t veclen[3] = { 0, 0, 0 };
+    for ( size_t v = 0; v < 3; v++ )
+    {
+        auto& values = object[ keys[v] ].get<kvs::Json::Array>();
+        for ( auto& f : values )
+        {
+            const std::string filename = BaseClass::dataFilename( path_name, f.get<std::string>() );
+            files.push_back( { v, veclen[v]++, filename } );
+        }
+
+        if ( veclen[v] == 0 )
+        {
+            BaseClass::setSuccess( false );
+            kvsMessageError() << "No data file in " << keys[v] << "." << std::endl;
+            return NULL;
+        }
+    }
+
+    // Allocate the interleaved value arrays.
+    kvs::ValueArray<kvs::Real32> values[3];
+    size_t nnodes[3] = { 0, 0, 0 };
+    for ( const auto& file : files )
+    {
+        if ( file.component != 0 ) { continue; }
+
+        const size_t v = file.volume;
+        nnodes[v] = BaseClass::numberOfValues<kvs::Real32>( file.filename, 4 );
+        if ( nnodes[v] == 0 )
+        {
+            BaseClass::setSuccess( false );
+            kvsMessageError() << "Cannot read " << file.filename << "." << std::endl;
+            return NULL;
+        }
+        values[v].allocate( nnodes[v] * veclen[v] );
+    }
+
+    // Read all of the component files concurrently into the interleaved arrays.
+    const bool swap = BaseClass::needsByteSwap( endian );
+    std::atomic<bool> success( true );
+    Parallel::For( 0, files.size(), [&]( const size_t index )
+    {
+        const ::DataFile& file = files[index];
+        const size_t v = file.volume;
+        kvs::Real32* dst = values[v].data() + file.component;
+        if ( !BaseClass::readBinary<kvs::Real32>( file.filename, 4, swap, dst, nnodes[v], veclen[v] ) )
+        {
+            success = false;
+        }
+    }, m_number_of_threads );
+
+    if ( !success )
+    {
+        BaseClass::setSuccess( false );
+        kvsMessageError() << "Cannot read the data files." << std::endl;
+        return NULL;
+    }
+
+    // Set up each volume object including its coordinates and min/max values.
+    auto& yin_volume = SuperClass::yinVolume();
+    auto& yang_volume = SuperClass::yangVolume();
+    auto& zhong_volume = SuperClass::zhongVolume();
+    Parallel::For( 0, 3, [&]( const size_t v )
+    {
+        switch ( v )
+        {
+        case 0:
+            yin_volume.setDimR( dim_rad );
+            yin_volume.setDimTheta( dim_lat );
+            yin_volume.setDimPhi( dim_lon );
+            yin_volume.setVeclen( veclen[0] );
+            yin_volume.setValues( values[0] );
+            yin_volume.updateMinMaxCoords();
+            yin_volume.updateMinMaxValues();
+            yin_volume.updateBrickMinMax();
+            break;
+        case 1:
+            yang_volume.setDimR( dim_rad );
+            yang_volume.setDimTheta( dim_lat );
+            yang_volume.setDimPhi( dim_lon );
+            yang_volume.setVeclen( veclen[1] );
+            yang_volume.setValues( values[1] );
+            yang_volume.updateMinMaxCoords();
+            yang_volume.updateMinMaxValues();
+            yang_volume.updateBrickMinMax();
+            break;
+        case 2:
+            zhong_volume.setDimR( dim_rad );
+            zhong_volume.setDim( dim_zhong );
+            zhong_volume.setVeclen( veclen[2] );
+            zhong_volume.setValues( values[2] );
+            zhong_volume.updateMinMaxCoords();
+            zhong_volume.updateMinMaxValues();
+            zhong_volume.updateBrickMinMax();
+            break;
+        default: break;
+        }
+    }, m_number_of_threads );
+
+    // Share the min/max values and coordinates among the volume objects.
+    SuperClass::updateMinMaxValues();
+    SuperClass::updateMinMaxCoords();
+
+    BaseClass::setSuccess( true );
+    return this;
+}
+
+} // end of namespace YYZVis
@@ -0,0 +1,37 @@
+#pragma once
+#include "ImporterBase.h"
+#include "YinYangZhongVolumeObject.h"
+
+
+namespace YYZVis
+{
+
+/*===========================================================================*/
+/**
+ *  @brief  Importer class for yin, yang and zhong volume objects.
+ *
+ *  The JSON descriptor is parsed once and all of the data files listed in
+ *  yin_value, yang_value and zhong_value are read concurrently.
+ */
+/*===========================================================================*/
+class YinYangZhongImporter : public YYZVis::ImporterBase, public YYZVis::YinYangZhongVolumeObject
+{
+    kvsModule( YYZVis::YinYangZhongImporter, Importer );
+    kvsModuleBaseClass( YYZVis::ImporterBase );
+    kvsModuleSuperClass( YYZVis::YinYangZhongVolumeObject );
+
+private:
+    size_t m_number_of_threads; ///< max. number of threads (0: number of hardware threads)
+
+public:
+    YinYangZhongImporter(): m_number_of_threads( 0 ) {}
+    YinYangZhongImporter( const kvs::FileFormatBase* file_format ): m_number_of_threads( 0 ) { this->exec( file_format ); }
+    YinYangZhongImporter( const std::string& filename, const size_t nthreads = 0 );
+
+    size_t numberOfThreads() const { return m_number_of_threads; }
+    void setNumberOfThreads( const size_t nthreads ) { m_number_of_threads = nthreads; }
+
+    SuperClass* exec( const kvs::FileFormatBase* file_format );
+};
+
+} // end of namespace YYZVis
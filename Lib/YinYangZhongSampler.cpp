@@ -0,0 +1,297 @@
+#include "YinYangZhongSampler.h"
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+
+namespace
+{
+
+/*===========================================================================*/
+/**
+ *  @brief  Splits the continuous node index into the base index and the local coordinate.
+ *  @param  f [in] continuous node index
+ *  @param  dim [in] number of nodes along the axis
+ *  @param  local [out] local coordinate in [0,1]
+ *  @return base index in [0,dim-2]
+ */
+/*===========================================================================*/
+inline size_t Split( const float f, const size_t dim, float* local )
+{
+    const float g = std::min( std::max( f, 0.0f ), float( dim - 1 ) );
+    const size_t base = std::min( size_t( g ), dim - 2 );
+    *local = g - float( base );
+    return base;
+}
+
+inline void LocateShell(
+    const YYZVis::YinYangVolumeObjectBase* volume,
+    const float r,
+    const float theta,
+    const float phi,
+    YYZVis::YinYangZhongSampler::Location* location )
+{
+    const YYZVis::YinYangVolumeObjectBase::Range range_r = volume->rangeR();
+    const YYZVis::YinYangVolumeObjectBase::Range range_theta = volume->rangeTheta();
+    const YYZVis::YinYangVolumeObjectBase::Range range_phi = volume->rangePhi();
+
+    // The nodes j and k are located at theta = min + d * (j - 1) and
+    // phi = min + d * (k - 2) respectively (see YinYangVolumeObjectBase).
+    const float fi = ( r - range_r.min ) / range_r.d;
+    const float fj = ( theta - range_theta.min ) / range_theta.d + 1.0f;
+    const float fk = ( phi - range_phi.min ) / range_phi.d + 2.0f;
+
+    float p, q, s;
+    const size_t i = ::Split( fi, volume->dimR(), &p );
+    const size_t j = ::Split( fj, volume->dimTheta(), &q );
+    const size_t k = ::Split( fk, volume->dimPhi(), &s );
+
+    const size_t dim0 = volume->dimR();
+    const size_t dim1 = dim0 * volume->dimTheta();
+    location->base_index = kvs::UInt32( i + dim0 * j + dim1 * k );
+    location->local = kvs::Vec3( p, q, s );
+}
+
+inline void LocateZhong(
+    const YYZVis::ZhongVolumeObject* volume,
+    const kvs::Vec3& point,
+    YYZVis::YinYangZhongSampler::Location* location )
+{
+    const size_t dim = volume->dim();
+    const kvs::Real32* const table = volume->coordTable().data();
+    const float min = table[0];
+    const float d = ( table[ dim - 1 ] - table[0] ) / float( dim - 1 );
+
+    float p, q, s;
+    const size_t i = ::Split( ( point.x() - min ) / d, dim, &p );
+    const size_t j = ::Split( ( point.y() - min ) / d, dim, &q );
+    const size_t k = ::Split( ( point.z() - min ) / d, dim, &s );
+
+    location->base_index = kvs::UInt32( i + dim * j + dim * dim * k );
+    location->local = kvs::Vec3( p, q, s );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Points located in a grid, evaluated at once with Grid::evaluate.
+ */
+/*===========================================================================*/
+struct Bucket
+{
+    std::vector<size_t> indices; ///< indices of the points
+    std::vector<kvs::UInt32> base_indices; ///< node indices of the base nodes
+    std::vector<kvs::Real32> p; ///< local coordinates along the first axis
+    std::vector<kvs::Real32> q; ///< local coordinates along the second axis
+    std::vector<kvs::Real32> r; ///< local coordinates along the third axis
+
+    void push( const size_t index, const YYZVis::YinYangZhongSampler::Location& location )
+    {
+        indices.push_back( index );
+        base_indices.push_back( location.base_index );
+        p.push_back( location.local.x() );
+        q.push_back( location.local.y() );
+        r.push_back( location.local.z() );
+    }
+
+    template <typename Grid>
+    void evaluate( const Grid& grid, const size_t n, kvs::Real32* values, kvs::Real32* gradients ) const
+    {
+        const size_t nbucket = indices.size();
+        if ( nbucket == 0 ) { return; }
+
+        std::vector<kvs::Real32> bucket_values( nbucket );
+        std::vector<kvs::Real32> bucket_gradients( gradients ? nbucket * 3 : 0 );
+        grid.evaluate(
+            nbucket, base_indices.data(), p.data(), q.data(), r.data(),
+            bucket_values.data(), gradients ? bucket_gradients.data() : NULL );
+
+        for ( size_t m = 0; m < nbucket; m++ )
+        {
+            const size_t index = indices[m];
+            values[index] = bucket_values[m];
+            if ( gradients )
+            {
+                gradients[ index ] = bucket_gradients[ m ];
+                gradients[ index + n ] = bucket_gradients[ m + nbucket ];
+                gradients[ index + 2 * n ] = bucket_gradients[ m + 2 * nbucket ];
+            }
+        }
+    }
+};
+
+} // end of namespace
+
+
+namespace YYZVis
+{
+
+YinYangZhongSampler::YinYangZhongSampler(
+    const YYZVis::YinYangVolumeObjectBase* yin_volume,
+    const YYZVis::YinYangVolumeObjectBase* yang_volume,
+    const YYZVis::ZhongVolumeObject* zhong_volume ):
+    m_yin_volume( yin_volume ),
+    m_yang_volume( yang_volume ),
+    m_zhong_volume( zhong_volume ),
+    m_yin_grid( yin_volume ),
+    m_yang_grid( yang_volume ),
+    m_zhong_grid( zhong_volume )
+{
+}
+
+YinYangZhongSampler::YinYangZhongSampler( const YYZVis::YinYangZhongVolumeObject& volume ):
+    m_yin_volume( &volume.yinVolume() ),
+    m_yang_volume( &volume.yangVolume() ),
+    m_zhong_volume( &volume.zhongVolume() ),
+    m_yin_grid( &volume.yinVolume() ),
+    m_yang_grid( &volume.yangVolume() ),
+    m_zhong_grid( &volume.zhongVolume() )
+{
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Locates the point in the yin, yang or zhong grid.
+ *  @param  point [in] Cartesian coordinates of the point
+ *  @return location (grid, base node index and local coordinates)
+ */
+/*===========================================================================*/
+const YinYangZhongSampler::Location YinYangZhongSampler::locate( const kvs::Vec3& point ) const
+{
+    Location location;
+    location.base_index = 0;
+    location.local = kvs::Vec3( 0.0f, 0.0f, 0.0f );
+
+    const float r = point.length();
+    if ( r > m_yin_volume->rangeR().max )
+    {
+        location.grid = Outside;
+        return location;
+    }
+
+    // Inside zhong volume region.
+    if ( r <= m_yin_volume->rangeR().min )
+    {
+        location.grid = Zhong;
+        ::LocateZhong( m_zhong_volume, point, &location );
+        return location;
+    }
+
+    // Inside yin volume region.
+    const float theta = std::acos( point.z() / r );
+    const float phi = std::atan2( point.y(), point.x() );
+    const YinYangVolumeObjectBase::Range range_theta = m_yin_volume->rangeTheta();
+    const YinYangVolumeObjectBase::Range range_phi = m_yin_volume->rangePhi();
+    if ( range_theta.min <= theta && theta <= range_theta.max &&
+         range_phi.min <= phi && phi <= range_phi.max )
+    {
+        location.grid = Yin;
+        ::LocateShell( m_yin_volume, r, theta, phi, &location );
+        return location;
+    }
+
+    // Inside yang volume region; (x,y,z) -> (-x,z,y) in the yang frame.
+    const float yang_theta = std::acos( point.y() / r );
+    const float yang_phi = std::atan2( point.z(), -point.x() );
+    location.grid = Yang;
+    ::LocateShell( m_yang_volume, r, yang_theta, yang_phi, &location );
+    return location;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Samples the scalar value at the point.
+ *  @param  point [in] Cartesian coordinates of the point
+ *  @param  value [out] interpolated value
+ *  @return false if the point is outside of the volumes
+ */
+/*===========================================================================*/
+bool YinYangZhongSampler::sample( const kvs::Vec3& point, kvs::Real32* value ) const
+{
+    const Location location = this->locate( point );
+    const kvs::Real32 p = location.local.x();
+    const kvs::Real32 q = location.local.y();
+    const kvs::Real32 r = location.local.z();
+    switch ( location.grid )
+    {
+    case Yin: m_yin_grid.evaluate( 1, &location.base_index, &p, &q, &r, value ); break;
+    case Yang: m_yang_grid.evaluate( 1, &location.base_index, &p, &q, &r, value ); break;
+    case Zhong: m_zhong_grid.evaluate( 1, &location.base_index, &p, &q, &r, value ); break;
+    default: return false;
+    }
+
+    return true;
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Locates n points.
+ *  @param  n [in] number of points
+ *  @param  x [in] x coordinates of the points (n values)
+ *  @param  y [in] y coordinates of the points (n values)
+ *  @param  z [in] z coordinates of the points (n values)
+ *  @param  locations [out] locations of the points (n values)
+ */
+/*===========================================================================*/
+void YinYangZhongSampler::locate(
+    const size_t n,
+    const kvs::Real32* x,
+    const kvs::Real32* y,
+    const kvs::Real32* z,
+    Location* locations ) const
+{
+    for ( size_t m = 0; m < n; m++ )
+    {
+        locations[m] = this->locate( kvs::Vec3( x[m], y[m], z[m] ) );
+    }
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Samples the scalar values (and gradient vectors) at n points.
+ *  @param  n [in] number of points
+ *  @param  x [in] x coordinates of the points (n values)
+ *  @param  y [in] y coordinates of the points (n values)
+ *  @param  z [in] z coordinates of the points (n values)
+ *  @param  values [out] interpolated values (n values)
+ *  @param  gradients [out] gradient vectors in SoA layout (x, y and z components
+ *                          in [0,n), [n,2n) and [2n,3n)), or NULL for the values only
+ *  @param  outside_value [in] value set to the points outside of the volumes
+ *
+ *  The points are grouped by the grids and evaluated with the batched
+ *  evaluation of each grid.
+ */
+/*===========================================================================*/
+void YinYangZhongSampler::sample(
+    const size_t n,
+    const kvs::Real32* x,
+    const kvs::Real32* y,
+    const kvs::Real32* z,
+    kvs::Real32* values,
+    kvs::Real32* gradients,
+    const kvs::Real32 outside_value ) const
+{
+    ::Bucket buckets[3];
+    for ( size_t m = 0; m < n; m++ )
+    {
+        const Location location = this->locate( kvs::Vec3( x[m], y[m], z[m] ) );
+        if ( location.grid == Outside )
+        {
+            values[m] = outside_value;
+            if ( gradients )
+            {
+                gradients[ m ] = 0.0f;
+                gradients[ m + n ] = 0.0f;
+                gradients[ m + 2 * n ] = 0.0f;
+            }
+            continue;
+        }
+
+        buckets[ location.grid ].push( m, location );
+    }
+
+    buckets[ Yin ].evaluate( m_yin_grid, n, values, gradients );
+    buckets[ Yang ].evaluate( m_yang_grid, n, values, gradients );
+    buckets[ Zhong ].evaluate( m_zhong_grid, n, values, gradients );
+}
+
+} // end of namespace YYZVis
@@ -0,0 +1,85 @@
+#pragma once
+#include <kvs/Type>
+#include <kvs/Vector3>
+#include "YinYangVolumeObjectBase.h"
+#include "ZhongVolumeObject.h"
+#include "YinYangZhongVolumeObject.h"
+#include "YinYangGrid.h"
+#include "ZhongGrid.h"
+
+
+namespace YYZVis
+{
+
+/*===========================================================================*/
+/**
+ *  @brief  Sampler of the yin-yang-zhong field at Cartesian points.
+ *
+ *  A point is located in constant time by mapping it analytically to the
+ *  computational space of the grid: points with r <= rangeR().min belong to
+ *  the zhong grid, points inside the nominal (theta, phi) range of the yin
+ *  grid belong to the yin grid, and the others belong to the yang grid. The
+ *  sampler does not modify its state, so it can be shared by several threads.
+ */
+/*===========================================================================*/
+class YinYangZhongSampler
+{
+public:
+    enum GridType
+    {
+        Yin = 0,
+        Yang = 1,
+        Zhong = 2,
+        Outside = 3
+    };
+
+    struct Location
+    {
+        GridType grid; ///< grid including the point
+        kvs::UInt32 base_index; ///< node index of the base node of the cell
+        kvs::Vec3 local; ///< local coordinates in the cell
+    };
+
+private:
+    const YYZVis::YinYangVolumeObjectBase* m_yin_volume; ///< yin volume object
+    const YYZVis::YinYangVolumeObjectBase* m_yang_volume; ///< yang volume object
+    const YYZVis::ZhongVolumeObject* m_zhong_volume; ///< zhong volume object
+    YYZVis::YinYangGrid m_yin_grid; ///< yin grid
+    YYZVis::YinYangGrid m_yang_grid; ///< yang grid
+    YYZVis::ZhongGrid m_zhong_grid; ///< zhong grid
+
+public:
+    YinYangZhongSampler(
+        const YYZVis::YinYangVolumeObjectBase* yin_volume,
+        const YYZVis::YinYangVolumeObjectBase* yang_volume,
+        const YYZVis::ZhongVolumeObject* zhong_volume );
+    YinYangZhongSampler( const YYZVis::YinYangZhongVolumeObject& volume );
+
+    const YYZVis::YinYangVolumeObjectBase* yinVolume() const { return m_yin_volume; }
+    const YYZVis::YinYangVolumeObjectBase* yangVolume() const { return m_yang_volume; }
+    const YYZVis::ZhongVolumeObject* zhongVolume() const { return m_zhong_volume; }
+    const YYZVis::YinYangGrid& yinGrid() const { return m_yin_grid; }
+    const YYZVis::YinYangGrid& yangGrid() const { return m_yang_grid; }
+    const YYZVis::ZhongGrid& zhongGrid() const { return m_zhong_grid; }
+
+    const Location locate( const kvs::Vec3& point ) const;
+    bool sample( const kvs::Vec3& point, kvs::Real32* value ) const;
+
+    void locate(
+        const size_t n,
+        const kvs::Real32* x,
+        const kvs::Real32* y,
+        const kvs::Real32* z,
+        Location* locations ) const;
+
+    void sample(
+        const size_t n,
+        const kvs::Real32* x,
+        const kvs::Real32* y,
+        const kvs::Real32* z,
+        kvs::Real32* values,
+        kvs::Real32* gradients = NULL,
+        const kvs::Real32 outside_value = 0.0f ) const;
+};
+
+} // end of namespace YYZVis
@@ -0,0 +1,79 @@
+#include "YinYangZhongVolumeObject.h"
+#include <kvs/Math>
+
+
+namespace YYZVis
+{
+
+/*===========================================================================*/
+/**
+ *  @brief  Prints information of the volume objects.
+ *  @param  os [in] output stream
+ *  @param  indent [in] indent
+ */
+/*===========================================================================*/
+void YinYangZhongVolumeObject::print( std::ostream& os, const kvs::Indent& indent ) const
+{
+    const kvs::Indent next_indent = indent.nextIndent();
+    m_yin_volume.print( os << indent << "Yin volume object" << std::endl, next_indent );
+    m_yang_volume.print( os << indent << "Yang volume object" << std::endl, next_indent );
+    m_zhong_volume.print( os << indent << "Zhong volume object" << std::endl, next_indent );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Unifies the min/max values of the three volume objects.
+ *
+ *  The min/max values of each volume object must be calculated in advance.
+ */
+/*===========================================================================*/
+void YinYangZhongVolumeObject::updateMinMaxValues()
+{
+    const kvs::Real64 min_value = kvs::Math::Min(
+        m_yin_volume.minValue(),
+        m_yang_volume.minValue(),
+        m_zhong_volume.minValue() );
+    const kvs::Real64 max_value = kvs::Math::Max(
+        m_yin_volume.maxValue(),
+        m_yang_volume.maxValue(),
+        m_zhong_volume.maxValue() );
+    m_yin_volume.setMinMaxValues( min_value, max_value );
+    m_yang_volume.setMinMaxValues( min_value, max_value );
+    m_zhong_volume.setMinMaxValues( min_value, max_value );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Unifies the min/max coordinates of the three volume objects.
+ *
+ *  The min/max object coordinates of each volume object must be calculated
+ *  in advance.
+ */
+/*===========================================================================*/
+void YinYangZhongVolumeObject::updateMinMaxCoords()
+{
+    const kvs::Vec3& min_coord0 = m_yin_volume.minObjectCoord();
+    const kvs::Vec3& min_coord1 = m_yang_volume.minObjectCoord();
+    const kvs::Vec3& min_coord2 = m_zhong_volume.minObjectCoord();
+    const kvs::Vec3& max_coord0 = m_yin_volume.maxObjectCoord();
+    const kvs::Vec3& max_coord1 = m_yang_volume.maxObjectCoord();
+    const kvs::Vec3& max_coord2 = m_zhong_volume.maxObjectCoord();
+    const kvs::Vec3 min_coord(
+        kvs::Math::Min( min_coord0.x(), min_coord1.x(), min_coord2.x() ),
+        kvs::Math::Min( min_coord0.y(), min_coord1.y(), min_coord2.y() ),
+        kvs::Math::Min( min_coord0.z(), min_coord1.z(), min_coord2.z() ) );
+    const kvs::Vec3 max_coord(
+        kvs::Math::Max( max_coord0.x(), max_coord1.x(), max_coord2.x() ),
+        kvs::Math::Max( max_coord0.y(), max_coord1.y(), max_coord2.y() ),
+        kvs::Math::Max( max_coord0.z(), max_coord1.z(), max_coord2.z() ) );
+    m_yin_volume.setMinMaxObjectCoords( min_coord, max_coord );
+    m_yin_volume.setMinMaxExternalCoords( min_coord, max_coord );
+    m_yang_volume.setMinMaxObjectCoords( min_coord, max_coord );
+    m_yang_volume.setMinMaxExternalCoords( min_coord, max_coord );
+    m_zhong_volume.setMinMaxObjectCoords( min_coord, max_coord );
+    m_zhong_volume.setMinMaxExternalCoords( min_coord, max_coord );
+    BaseClass::setMinMaxObjectCoords( min_coord, max_coord );
+    BaseClass::setMinMaxExternalCoords( min_coord, max_coord );
+}
+
+} // end of namespace YYZVis
@@ -0,0 +1,45 @@
+#pragma once
+#include <ostream>
+#include <kvs/Module>
+#include <kvs/ObjectBase>
+#include <kvs/Indent>
+#include "YinVolumeObject.h"
+#include "YangVolumeObject.h"
+#include "ZhongVolumeObject.h"
+
+
+namespace YYZVis
+{
+
+/*===========================================================================*/
+/**
+ *  @brief  Composite of yin, yang and zhong volume objects.
+ */
+/*===========================================================================*/
+class YinYangZhongVolumeObject : public kvs::ObjectBase
+{
+    kvsModule( YYZVis::YinYangZhongVolumeObject, Object );
+    kvsModuleBaseClass( kvs::ObjectBase );
+
+private:
+    YYZVis::YinVolumeObject m_yin_volume; ///< yin volume object
+    YYZVis::YangVolumeObject m_yang_volume; ///< yang volume object
+    YYZVis::ZhongVolumeObject m_zhong_volume; ///< zhong volume object
+
+public:
+    YinYangZhongVolumeObject() {}
+
+    void print( std::ostream& os, const kvs::Indent& indent = kvs::Indent(0) ) const;
+
+    const YYZVis::YinVolumeObject& yinVolume() const { return m_yin_volume; }
+    const YYZVis::YangVolumeObject& yangVolume() const { return m_yang_volume; }
+    const YYZVis::ZhongVolumeObject& zhongVolume() const { return m_zhong_volume; }
+    YYZVis::YinVolumeObject& yinVolume() { return m_yin_volume; }
+    YYZVis::YangVolumeObject& yangVolume() { return m_yang_volume; }
+    YYZVis::ZhongVolumeObject& zhongVolume() { return m_zhong_volume; }
+
+    void updateMinMaxValues();
+    void updateMinMaxCoords();
+};
+
+} // end of namespace YYZVis
@@ -2,96 +2,84 @@
 #include "ZhongVolumeObject.h"
 #include "ZhongGrid.h"
 #include "DensityMap.h"
+#include "BrickMinMax.h"
+#include "ParticleBuffer.h"
+#include "Philox.h"
 #include <kvs/Timer>
+#include <vector>
 
 namespace
 {
 
-inline kvs::Real32 RandomNumber()
-{
-    static kvs::UInt32 x=123456789,y=362436069,z=521288629,w=88675123;
-    kvs::UInt32 t;
-    t=(x^(x<<11));
-    x=y;y=z;z=w;
-    w=(w^(w>>19))^(t^(t>>8));
-    return w * ( 1.0f / 4294967296.0f );
-}
-
-}
-
-
-namespace
-{
-
-struct Particle
-{
-    kvs::Vec3 coord; ///< coordinate value
-    kvs::Vec3 normal; ///< normal vector
-    kvs::Real32 scalar; ///< scalar value
-};
-
-class Particles
-{
-private:
-    std::vector<kvs::Real32> m_coords; ///< coorinate value array
-    std::vector<kvs::Real32> m_normals; ///< normal vector array
-    std::vector<kvs::UInt8> m_colors; ///< color value array
-
-public:
-    Particles() {}
-    kvs::ValueArray<kvs::Real32> coords() const { return kvs::ValueArray<kvs::Real32>( m_coords ); }
-    kvs::ValueArray<kvs::Real32> normals() const { return kvs::ValueArray<kvs::Real32>( m_normals ); }
-    kvs::ValueArray<kvs::UInt8> colors() const { return kvs::ValueArray<kvs::UInt8>( m_colors ); }
-    void push( const Particle& particle, const kvs::ColorMap& color_map )
-    {
-        const kvs::RGBColor color = color_map.at( particle.scalar );
-        m_coords.push_back( particle.coord.x() );
-        m_coords.push_back( particle.coord.y() );
-        m_coords.push_back( particle.coord.z() );
-        m_normals.push_back( particle.normal.x() );
-        m_normals.push_back( particle.normal.y() );
-        m_normals.push_back( particle.normal.z() );
-        m_colors.push_back( color.r() );
-        m_colors.push_back( color.g() );
-        m_colors.push_back( color.b() );
-    }
-};
+using YYZVis::Internal::ActiveBricks;
+using YYZVis::Internal::Particle;
+using YYZVis::Internal::Particles;
+using YYZVis::Internal::ParticleBuffer;
 
 class Sampler
 {
 private:
     YYZVis::ZhongGrid* m_grid;
     YYZVis::DensityMap* m_density_map;
-    Particles m_particles; ///< particles
+    Particles* m_particles; ///< particles (reference)
     Particle m_current; ///< current sampled point
     Particle m_trial; ///< trial point
+    YYZVis::Philox m_random; ///< random number generator
+    kvs::UInt32 m_stream; ///< stream of the random numbers
+    size_t m_cell_index; ///< index of the bound cell
 
 public:
     Sampler(
         YYZVis::ZhongGrid* grid,
-        YYZVis::DensityMap* density_map ):
+        YYZVis::DensityMap* density_map,
+        const kvs::UInt32 seed = 0 ):
         m_grid( grid ),
-        m_density_map( density_map ) {}
+        m_density_map( density_map ),
+        m_particles( NULL ),
+        m_random( seed ),
+        m_stream( 0 ),
+        m_cell_index( 0 ) {}
+
+    const Particles& particles() const { return *m_particles; }
+    void attachParticles( Particles* particles ) { m_particles = particles; }
 
-    const Particles& particles() const { return m_particles; }
+    kvs::Real32 random() { return m_random(); }
 
-    void bind( const kvs::Vec3ui& base_index )
+    void bind( const kvs::Vec3ui& base_index, const size_t cell_index )
     {
+        // The random numbers of the cell are keyed by (seed, stream, cell index).
         m_grid->bind( base_index );
+        m_cell_index = cell_index;
+        m_random.setCounter( m_stream, cell_index );
+    }
+
+    void setStream( const kvs::UInt32 stream )
+    {
+        m_stream = stream;
+        m_random.setCounter( m_stream, m_cell_index );
+    }
+
+    size_t numberOfParticles( const kvs::Real32 expected )
+    {
+        // Stochastic rounding of the expected number.
+        const kvs::Real32 R = m_random();
+        size_t n = static_cast<size_t>( expected );
+        if ( expected - n > R ) { ++n; }
+        return n;
     }
 
-    size_t numberOfParticles(const YYZVis::ZhongVolumeObject* object )
+    kvs::Real32 expectedNumberOfParticles( const YYZVis::ZhongVolumeObject* object )
     {
         const kvs::Real32 scalar = this->averaged_scalar();
         kvs::Real32 overlapweight = averaged_overlapweight( object );
         const kvs::Real32 density = m_density_map->at( scalar , overlapweight );
-        const kvs::Real32 volume = m_grid->volume();
-        return this->number_of_particles( density, volume );
+        const kvs::Real32 volume = object->cellVolume();
+        return density * volume;
     }
 
     kvs::Real32 sample()
     {
-        m_current.coord = m_grid->randomSampling();
+        m_current.coord = this->random_sampling();
         m_current.normal = -m_grid->gradientVector();
         m_current.scalar = m_grid->scalar();
         return m_density_map->at( m_current.scalar );
@@ -122,7 +110,7 @@ public:
 
     kvs::Real32 trySample()
     {
-        m_trial.coord = m_grid->randomSampling();
+        m_trial.coord = this->random_sampling();
         m_trial.normal = -m_grid->gradientVector();
         m_trial.scalar = m_grid->scalar();
         return m_density_map->at( m_trial.scalar );
@@ -134,7 +122,7 @@ public:
         size_t counter = 0;
         while ( flag == false )
         {
-            m_current.coord = m_grid->randomSampling();
+            m_current.coord = this->random_sampling();
             counter++;
             if ( judge_zhong_overlap( object, m_current.coord ) == 0 || counter > 5 ) { flag = true; }
         }
@@ -164,7 +152,7 @@ public:
         size_t counter = 0;
         while( flag == false )
         {
-            m_trial.coord = m_grid->randomSampling();
+            m_trial.coord = this->random_sampling();
             counter++;
             if ( judge_zhong_overlap( object, m_trial.coord ) == 0 || counter > 5 ) { flag = true; }
         }
@@ -175,12 +163,12 @@ public:
 
     void accept( const kvs::ColorMap& cmap )
     {
-        m_particles.push( m_current, cmap );
+        m_particles->push( m_current, cmap );
     }
 
     void acceptTrial( const kvs::ColorMap& cmap )
     {
-        m_particles.push( m_trial, cmap );
+        m_particles->push( m_trial, cmap );
         m_current.coord = m_trial.coord;
         m_current.normal = m_trial.normal;
         m_current.scalar = m_trial.scalar;
@@ -290,13 +278,9 @@ private:
             m_grid->value(7) ) / 8.0f;
     }
 
-    size_t number_of_particles( const kvs::Real32 density, const kvs::Real32 volume ) const
+    kvs::Vec3 random_sampling()
     {
-        const kvs::Real32 R = ::RandomNumber();
-        const kvs::Real32 N = density * volume;
-        size_t n = static_cast<size_t>( N );
-        if ( N - n > R ) { ++n; }
-        return n;
+        return m_grid->randomSampling( m_random );
     }
 };
 
@@ -306,6 +290,18 @@ private:
 namespace YYZVis
 {
 
+ZhongGridSampling::ZhongGridSampling():
+    kvs::MapperBase(),
+    kvs::PointObject(),
+    m_camera( 0 ),
+    m_subpixel_level( 1 ),
+    m_sampling_step( 0.5f ),
+    m_object_depth( 0.0f ),
+    m_seed( 0 ),
+    m_nensembles( 1 )
+{
+}
+
 ZhongGridSampling::ZhongGridSampling(
     const kvs::VolumeObjectBase* volume,
     const size_t subpixel_level,
@@ -314,7 +310,9 @@ ZhongGridSampling::ZhongGridSampling(
     const float object_depth ):
     kvs::MapperBase( transfer_function ),
     kvs::PointObject(),
-    m_camera( 0 )
+    m_camera( 0 ),
+    m_seed( 0 ),
+    m_nensembles( 1 )
 {
     this->setSubpixelLevel( subpixel_level );
     this->setSamplingStep( sampling_step );
@@ -328,7 +326,9 @@ ZhongGridSampling::ZhongGridSampling(
     const size_t subpixel_level,
     const float sampling_step,
     const kvs::TransferFunction& transfer_function,
-    const float object_depth )
+    const float object_depth ):
+    m_seed( 0 ),
+    m_nensembles( 1 )
 {
     this->attachCamera( camera );
     this->setSubpixelLevel( subpixel_level );
@@ -372,6 +372,42 @@ ZhongGridSampling::SuperClass* ZhongGridSampling::exec( const kvs::ObjectBase* o
     return this;
 }
 
+/*===========================================================================*/
+/**
+ *  @brief  Returns a point object of the ensemble member.
+ *  @param  index [in] index of the ensemble member
+ *  @return point object including the particles of the member
+ *
+ *  When the member has all the particles (single member), the particle
+ *  arrays are shared with this object without copying. The arrays are never
+ *  modified in place, since the sampling sets newly allocated arrays.
+ */
+/*===========================================================================*/
+kvs::PointObject* ZhongGridSampling::newEnsemble( const size_t index ) const
+{
+    KVS_ASSERT( index < m_nensembles );
+
+    const size_t offset = m_ensemble_offsets[ index ] * 3;
+    const size_t size = ( m_ensemble_offsets[ index + 1 ] - m_ensemble_offsets[ index ] ) * 3;
+    kvs::PointObject* object = new kvs::PointObject();
+    if ( size == SuperClass::coords().size() )
+    {
+        object->setCoords( SuperClass::coords() );
+        object->setColors( SuperClass::colors() );
+        object->setNormals( SuperClass::normals() );
+    }
+    else
+    {
+        object->setCoords( kvs::ValueArray<kvs::Real32>( SuperClass::coords().data() + offset, size ) );
+        object->setColors( kvs::ValueArray<kvs::UInt8>( SuperClass::colors().data() + offset, size ) );
+        object->setNormals( kvs::ValueArray<kvs::Real32>( SuperClass::normals().data() + offset, size ) );
+    }
+    object->setSize( 1.0f );
+    object->setMinMaxObjectCoords( SuperClass::minObjectCoord(), SuperClass::maxObjectCoord() );
+    object->setMinMaxExternalCoords( SuperClass::minExternalCoord(), SuperClass::maxExternalCoord() );
+    return object;
+}
+
 void ZhongGridSampling::mapping( const YYZVis::ZhongVolumeObject* volume )
 {
     KVS_ASSERT( volume != NULL );
@@ -388,62 +424,107 @@ void ZhongGridSampling::mapping( const YYZVis::ZhongVolumeObject* volume )
     density_map.attachObject( volume );
     density_map.create( BaseClass::transferFunction().opacityMap() );
 
-    ::Sampler sampler( &grid, &density_map );
+    ::Sampler sampler( &grid, &density_map, m_seed );
     const size_t dim = volume->dim(); // resolution
+    const size_t nensembles = m_nensembles;
     const kvs::ColorMap color_map( BaseClass::transferFunction().colorMap() );
     size_t overlap_flag = 0; 
     kvs::Timer timer;
     kvs::Timer timer2;
     float sum=0.0f;
+
+    // The cells in the bricks, whose densities are zero in the value range,
+    // are skipped since no particles are generated in them.
+    const kvs::Vec3ui resolution( dim, dim, dim );
+    YYZVis::BrickMinMax bricks = volume->brickMinMax();
+    if ( !bricks.isValid( volume->values(), resolution ) && volume->veclen() == 1 ) { bricks.create( volume->values(), resolution ); }
+    const std::vector<kvs::UInt8> active_bricks = ::ActiveBricks( bricks, density_map );
+
+    // The ensemble member e of a cell uses the random number streams 2e
+    // (number of particles) and 2e+1 (sampling). Since the numbers of particles
+    // are reproduced from the stream 2e, they are drawn in advance to allocate
+    // the output arrays of all the members at once.
+    const size_t ncells = ( dim - 1 ) * ( dim - 1 ) * ( dim - 1 );
+    std::vector<kvs::Real32> cell_nexpected( ncells, 0.0f );
+    std::vector<size_t> capacities( nensembles, 0 );
     timer.start();
+    size_t index = 0;
     for ( size_t k = 0; k < dim - 1; k++ )
     {
         for ( size_t j = 0; j < dim - 1; j++ )
         {
-            for ( size_t i = 0; i < dim - 1; i++ )
+            for ( size_t i = 0; i < dim - 1; i++, index++ )
             {
-                sampler.bind( kvs::Vec3ui( i, j, k ) );
+                if ( !bricks.isEmpty() && !active_bricks[ bricks.brickIndex( i, j, k ) ] ) continue;
+
+                sampler.bind( kvs::Vec3ui( i, j, k ), index );
                 timer2.start();
-                const size_t nparticles = sampler.numberOfParticles( volume );
+                const kvs::Real32 nexpected = sampler.expectedNumberOfParticles( volume );
                 timer2.stop();
                 sum += timer2.sec();
-                const size_t max_loops = nparticles * 10;
-                if ( nparticles == 0 ) continue;
+                cell_nexpected[ index ] = nexpected;
+                if ( nexpected == 0.0f ) continue;
 
-                size_t nduplications = 0;
-                size_t counter = 0;
-                kvs::Real32 density;
-                if( overlap_flag == 0 || overlap_flag == 255 )
+                for ( size_t e = 0; e < nensembles; e++ )
                 {
-                    density =  sampler.sample( max_loops );
+                    sampler.setStream( kvs::UInt32( 2 * e ) );
+                    capacities[e] += sampler.numberOfParticles( nexpected );
                 }
-                else //1 <=  flag <= 254
-                {
-                    //std::cout << "checkflag = " << overlap_flag << std::endl;
-                    density = sampler.sampleOverlap( max_loops, volume );
-                }
-                while ( counter < nparticles )
+            } // end of i-loop
+        } // end of j-loop
+    } // end of k-loop
+
+    ::ParticleBuffer buffer;
+    buffer.allocate( capacities );
+    std::vector< ::Particles > members( nensembles );
+    for ( size_t e = 0; e < nensembles; e++ ) { members[e] = buffer.slice( e ); }
+
+    index = 0;
+    for ( size_t k = 0; k < dim - 1; k++ )
+    {
+        for ( size_t j = 0; j < dim - 1; j++ )
+        {
+            for ( size_t i = 0; i < dim - 1; i++, index++ )
+            {
+                const kvs::Real32 nexpected = cell_nexpected[ index ];
+                if ( nexpected == 0.0f ) continue;
+
+                sampler.bind( kvs::Vec3ui( i, j, k ), index );
+                for ( size_t e = 0; e < nensembles; e++ )
                 {
-                    kvs::Real32 density_trial;
-                    if ( overlap_flag == 0 || overlap_flag == 255 )
+                    sampler.setStream( kvs::UInt32( 2 * e ) );
+                    const size_t nparticles = sampler.numberOfParticles( nexpected );
+                    const size_t max_loops = nparticles * 10;
+                    if ( nparticles == 0 ) continue;
+
+                    sampler.setStream( kvs::UInt32( 2 * e + 1 ) );
+                    sampler.attachParticles( &members[e] );
+                    size_t nduplications = 0;
+                    size_t counter = 0;
+                    kvs::Real32 density;
+                    if( overlap_flag == 0 || overlap_flag == 255 )
                     {
-                        density_trial = sampler.trySample();
+                        density =  sampler.sample( max_loops );
                     }
                     else //1 <=  flag <= 254
                     {
-                        density_trial = sampler.trySampleOverlap( volume );
+                        //std::cout << "checkflag = " << overlap_flag << std::endl;
+                        density = sampler.sampleOverlap( max_loops, volume );
                     }
-
-                    const kvs::Real32 ratio = density_trial / density;
-                    if ( ratio >= 1.0f )
+                    while ( counter < nparticles )
                     {
-                        sampler.acceptTrial( color_map );
-                        density = density_trial;
-                        counter++;
-                    }
-                    else
-                    {
-                        if ( ratio >= ::RandomNumber() )
+                        kvs::Real32 density_trial;
+                        if ( overlap_flag == 0 || overlap_flag == 255 )
+                        {
+                            density_trial = sampler.trySample();
+                        }
+                        else //1 <=  flag <= 254
+                        {
+                            density_trial = sampler.trySampleOverlap( volume );
+                        }
+
+                        const kvs::Real32 ratio = density_trial / density;
+                        if ( ratio >= 1.0f )
                         {
                             sampler.acceptTrial( color_map );
                             density = density_trial;
@@ -451,24 +532,51 @@ void ZhongGridSampling::mapping( const YYZVis::ZhongVolumeObject* volume )
                         }
                         else
                         {
+                            if ( ratio >= sampler.random() )
+                            {
+                                sampler.acceptTrial( color_map );
+                                density = density_trial;
+                                counter++;
+                            }
+                            else
+                            {
 #ifdef DUPLICATION
-                            sampler.accept( color_map );
-                            counter++;
+                                sampler.accept( color_map );
+                                counter++;
 #else
-                            if ( ++nduplications > max_loops ) { break; }
+                                if ( ++nduplications > max_loops )
+                                {
+                                    // As in the Metropolis-Hastings algorithm, the remaining
+                                    // particles stay at the current point.
+                                    if ( density > 0.0f )
+                                    {
+                                        for ( ; counter < nparticles; counter++ ) { sampler.accept( color_map ); }
+                                    }
+                                    break;
+                                }
 #endif
+                            }
                         }
-                    }
-                } // end of while-loop
+                    } // end of while-loop
+                } // end of e-loop
             } // end of i-loop
         } // end of j-loop
     } // end of k-loop
+
+    // The members are stored one after another.
+    m_ensemble_offsets.assign( nensembles + 1, 0 );
+    for ( size_t e = 0; e < nensembles; e++ )
+    {
+        buffer.setSize( e, members[e].size() );
+        m_ensemble_offsets[ e + 1 ] = m_ensemble_offsets[ e ] + members[e].size();
+    }
+    buffer.compact();
     timer.stop();
 //    std::cout << "calc nparticle time" << sum << std::endl;
 //    std::cout << "generate particle time " << timer.sec() - sum << std::endl;
-    SuperClass::setCoords( sampler.particles().coords() );
-    SuperClass::setColors( sampler.particles().colors() );
-    SuperClass::setNormals( sampler.particles().normals() );
+    SuperClass::setCoords( buffer.coords() );
+    SuperClass::setColors( buffer.colors() );
+    SuperClass::setNormals( buffer.normals() );
     SuperClass::setSize( 1.0f );
 }
 
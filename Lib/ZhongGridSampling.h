@@ -4,6 +4,7 @@
 #include <kvs/PointObject>
 #include <kvs/VolumeObjectBase>
 #include <kvs/Module>
+#include <vector>
 #include "ZhongVolumeObject.h"
 
 
@@ -13,6 +14,9 @@ namespace YYZVis
 /*===========================================================================*/
 /**
  *  @brief  Particle generation class for Zhong grid.
+ *
+ *  The ensemble members are generated and stored in the same way as
+ *  YinYangGridSampling.
  */
 /*===========================================================================*/
 class ZhongGridSampling : public kvs::MapperBase, public kvs::PointObject
@@ -26,8 +30,12 @@ private:
     size_t m_subpixel_level; ///< subpixel level
     float m_sampling_step; ///< sampling step in the object coordinate
     float m_object_depth; ///< object depth
+    kvs::UInt32 m_seed; ///< seed of the random numbers
+    size_t m_nensembles; ///< number of ensemble members
+    std::vector<size_t> m_ensemble_offsets; ///< first particle of each ensemble member
 
 public:
+    ZhongGridSampling();
     ZhongGridSampling(
         const kvs::VolumeObjectBase* volume,
         const size_t subpixel_level,
@@ -48,11 +56,18 @@ public:
     size_t subpixelLevel() const { return m_subpixel_level; }
     float samplingStep() const { return m_sampling_step; }
     float objectDepth() const { return m_object_depth; }
+    kvs::UInt32 seed() const { return m_seed; }
+    size_t numberOfEnsembles() const { return m_nensembles; }
+    size_t ensembleOffset( const size_t index ) const { return m_ensemble_offsets[ index ]; }
+    size_t ensembleSize( const size_t index ) const { return m_ensemble_offsets[ index + 1 ] - m_ensemble_offsets[ index ]; }
+    kvs::PointObject* newEnsemble( const size_t index ) const;
 
     void attachCamera( const kvs::Camera* camera ) { m_camera = camera; }
     void setSubpixelLevel( const size_t subpixel_level ) { m_subpixel_level = subpixel_level; }
     void setSamplingStep( const float step ) { m_sampling_step = step; }
     void setObjectDepth( const float depth ) { m_object_depth = depth; }
+    void setSeed( const kvs::UInt32 seed ) { m_seed = seed; }
+    void setNumberOfEnsembles( const size_t nensembles ) { m_nensembles = nensembles > 0 ? nensembles : 1; }
 
 private:
     void mapping( const YYZVis::ZhongVolumeObject* volume );
@@ -1,4 +1,5 @@
 #include "ZhongVolumeObject.h"
+#include "Parallel.h"
 #include <kvs/Endian>
 #include <fstream>
 
@@ -9,33 +10,27 @@ namespace
 kvs::ValueArray<kvs::Real32> CalculateCoords( const YYZVis::ZhongVolumeObject* object )
 {
     const size_t dim = object->dim();
-    const float r_min = object->rangeR().min;
-    const float r_d = object->rangeR().d;
-
-    //ix(= iy, iz),dix(= diy, diz)
-    const float r_i = r_min + r_d * 2;
-    const float ix_max = r_i;
-    const float ix_min = -r_i;
-    const float dix = ( ix_max - ix_min ) / ( dim - 1 );
+    const kvs::Real32* const table = object->coordTable().data();
 
     const size_t nnodes = object->numberOfNodes();
     kvs::ValueArray<kvs::Real32> coords( nnodes * 3 );
-    kvs::Real32* pcoords = coords.data();
-    for ( size_t k = 0; k < dim; k++ )
+    kvs::Real32* const pcoords0 = coords.data();
+    YYZVis::Parallel::For( 0, dim, [&]( const size_t k )
     {
-        const float z = ix_min + dix * k;
+        const float z = table[k];
+        kvs::Real32* pcoords = pcoords0 + 3 * dim * dim * k;
         for ( size_t j = 0; j < dim; j++ )
         {
-            const float y = ix_min + dix * j;
+            const float y = table[j];
             for ( size_t i = 0; i < dim; i++ )
             {
-                const float x = ix_min + dix * i;
+                const float x = table[i];
                 *(pcoords++) = x;
                 *(pcoords++) = y;
                 *(pcoords++) = z;
             }
         }
-    }
+    } );
 
     return coords;
 }
@@ -124,6 +119,9 @@ void ZhongVolumeObject::shallowCopy( const ZhongVolumeObject& object )
     m_dim = object.m_dim;
     m_dim_r = object.m_dim_r;
     m_range_r = object.m_range_r;
+    m_coord_table = object.m_coord_table;
+    m_brick_min_max = object.m_brick_min_max;
+    m_span_space_index = object.m_span_space_index;
 }
 
 void ZhongVolumeObject::deepCopy( const ZhongVolumeObject& object )
@@ -132,6 +130,9 @@ void ZhongVolumeObject::deepCopy( const ZhongVolumeObject& object )
     m_dim = object.m_dim;
     m_dim_r = object.m_dim_r;
     m_range_r = object.m_range_r;
+    m_coord_table = object.m_coord_table;
+    m_brick_min_max = object.m_brick_min_max;
+    m_span_space_index = object.m_span_space_index;
 }
 
 void ZhongVolumeObject::print( std::ostream& os, const kvs::Indent& indent ) const
@@ -157,6 +158,15 @@ void ZhongVolumeObject::setDimR( const size_t dim_r, const float range_min, cons
     m_range_r.max = range_max;
     m_range_r.min = range_min;
     m_range_r.d = ( m_range_r.max - m_range_r.min ) / ( m_dim_r - 1 );
+
+    this->update_coord_table();
+}
+
+void ZhongVolumeObject::setDim( const size_t dim )
+{
+    m_dim = dim;
+
+    this->update_coord_table();
 }
 
 size_t ZhongVolumeObject::numberOfNodes() const
@@ -189,39 +199,16 @@ bool ZhongVolumeObject::readValues( const std::string& filename )
     kvs::Endian::Swap( values.data(), nnodes * veclen );
 
     this->setValues( kvs::AnyValueArray( values ) );
+    m_brick_min_max.release();
+    m_span_space_index.release();
 
     return true;
 }
 
 void ZhongVolumeObject::updateMinMaxCoords()
 {
-    kvs::Vec3 min_coord( 0.0f, 0.0f, 0.0f );
-    kvs::Vec3 max_coord( 0.0f, 0.0f, 0.0f );
-
-    const float* coord = this->coords().data();
-    const float* const end = coord + this->coords().size();
-
-    float x = *( coord++ );
-    float y = *( coord++ );
-    float z = *( coord++ );
-
-    min_coord.set( x, y, z );
-    max_coord.set( x, y, z );
-
-    while ( coord < end )
-    {
-        x = *( coord++ );
-        y = *( coord++ );
-        z = *( coord++ );
-
-        min_coord.x() = kvs::Math::Min( min_coord.x(), x );
-        min_coord.y() = kvs::Math::Min( min_coord.y(), y );
-        min_coord.z() = kvs::Math::Min( min_coord.z(), z );
-
-        max_coord.x() = kvs::Math::Max( max_coord.x(), x );
-        max_coord.y() = kvs::Math::Max( max_coord.y(), y );
-        max_coord.z() = kvs::Math::Max( max_coord.z(), z );
-    }
+    const kvs::Vec3 min_coord = this->coord( 0, 0, 0 );
+    const kvs::Vec3 max_coord = this->coord( m_dim - 1, m_dim - 1, m_dim - 1 );
 
     this->setMinMaxObjectCoords( min_coord, max_coord );
 
@@ -233,4 +220,51 @@ void ZhongVolumeObject::updateMinMaxCoords()
     }
 }
 
+/*===========================================================================*/
+/**
+ *  @brief  Updates the min/max values of the bricks of the cells.
+ *  @param  brick_size [in] number of cells along each axis of a brick
+ */
+/*===========================================================================*/
+void ZhongVolumeObject::updateBrickMinMax( const size_t brick_size )
+{
+    if ( this->veclen() != 1 ) { m_brick_min_max.release(); return; }
+    const kvs::Vec3ui resolution( m_dim, m_dim, m_dim );
+    m_brick_min_max.create( BaseClass::values(), resolution, brick_size );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Updates the span space index of the cells.
+ *  @param  nbuckets [in] number of buckets of the min. values of the cells
+ *
+ *  The index is optional, and should be updated again when the values are
+ *  changed. It pays off when many isosurfaces are extracted from the volume.
+ */
+/*===========================================================================*/
+void ZhongVolumeObject::updateSpanSpaceIndex( const size_t nbuckets )
+{
+    if ( this->veclen() != 1 ) { m_span_space_index.release(); return; }
+    const kvs::Vec3ui resolution( m_dim, m_dim, m_dim );
+    m_span_space_index.create( BaseClass::values(), resolution, nbuckets );
+}
+
+void ZhongVolumeObject::update_coord_table()
+{
+    // The table is available after both of the resolutions are specified.
+    if ( m_dim < 2 || m_dim_r < 2 ) { m_coord_table.release(); return; }
+
+    //ix(= iy, iz),dix(= diy, diz)
+    const float r_i = m_range_r.min + m_range_r.d * 2;
+    const float ix_max = r_i;
+    const float ix_min = -r_i;
+    const float dix = ( ix_max - ix_min ) / ( m_dim - 1 );
+
+    m_coord_table.allocate( m_dim );
+    for ( size_t i = 0; i < m_dim; i++ )
+    {
+        m_coord_table[i] = ix_min + dix * i;
+    }
+}
+
 } // end of namespace YYZVis
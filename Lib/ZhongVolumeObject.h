@@ -4,6 +4,8 @@
 #include <kvs/VolumeObjectBase>
 #include <kvs/StructuredVolumeObject>
 #include <kvs/UnstructuredVolumeObject>
+#include "BrickMinMax.h"
+#include "SpanSpaceIndex.h"
 
 
 namespace YYZVis
@@ -35,6 +37,9 @@ private:
     size_t m_dim; ///< resolution
     size_t m_dim_r; ///< resolution in radius
     Range m_range_r; ///< range of radius
+    kvs::ValueArray<kvs::Real32> m_coord_table; ///< coordinate at each node along x (= y, z)
+    YYZVis::BrickMinMax m_brick_min_max; ///< min/max values of the bricks of the cells
+    YYZVis::SpanSpaceIndex m_span_space_index; ///< span space index of the cells (optional)
 
 public:
     ZhongVolumeObject();
@@ -44,18 +49,72 @@ public:
     void deepCopy( const ZhongVolumeObject& object );
     void print( std::ostream& os, const kvs::Indent& indent = kvs::Indent(0) ) const;
 
-    void setDim( const size_t dim ) { m_dim = dim; }
+    void setDim( const size_t dim );
     void setDimR( const size_t dim_r, const float range_min = 0.35f, const float range_max = 1.0f );
 
     size_t dim() const { return m_dim; }
     size_t dimR() const { return m_dim_r; }
     Range rangeR() const { return m_range_r; }
 
+    const kvs::ValueArray<kvs::Real32>& coordTable() const { return m_coord_table; }
+    const YYZVis::BrickMinMax& brickMinMax() const { return m_brick_min_max; }
+    const YYZVis::SpanSpaceIndex& spanSpaceIndex() const { return m_span_space_index; }
+
     size_t numberOfNodes() const;
     size_t numberOfCells() const;
+    bool hasCoords() const { return BaseClass::coords().size() != 0; }
+    const kvs::Vec3 coord( const size_t i, const size_t j, const size_t k ) const;
+    const kvs::Vec3 coord( const size_t index ) const;
+    const kvs::Real32 cellVolume() const;
     void calculateCoords();
     bool readValues( const std::string& filename );
     void updateMinMaxCoords();
+    void updateBrickMinMax( const size_t brick_size = YYZVis::BrickMinMax::DefaultBrickSize );
+    void updateSpanSpaceIndex( const size_t nbuckets = YYZVis::SpanSpaceIndex::DefaultNumberOfBuckets );
+
+private:
+    void update_coord_table();
 };
 
+/*===========================================================================*/
+/**
+ *  @brief  Returns the coordinate of the node (i,j,k).
+ *  @param  i [in] node index along x
+ *  @param  j [in] node index along y
+ *  @param  k [in] node index along z
+ *  @return coordinate calculated from the coordinate table
+ */
+/*===========================================================================*/
+inline const kvs::Vec3 ZhongVolumeObject::coord( const size_t i, const size_t j, const size_t k ) const
+{
+    return kvs::Vec3( m_coord_table[i], m_coord_table[j], m_coord_table[k] );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns the coordinate of the node.
+ *  @param  index [in] node index
+ *  @return coordinate calculated from the coordinate table
+ */
+/*===========================================================================*/
+inline const kvs::Vec3 ZhongVolumeObject::coord( const size_t index ) const
+{
+    const size_t i = index % m_dim;
+    const size_t j = ( index / m_dim ) % m_dim;
+    const size_t k = index / ( m_dim * m_dim );
+    return this->coord( i, j, k );
+}
+
+/*===========================================================================*/
+/**
+ *  @brief  Returns the volume of the cell.
+ *  @return volume of the cubic cell (the same for all of the cells)
+ */
+/*===========================================================================*/
+inline const kvs::Real32 ZhongVolumeObject::cellVolume() const
+{
+    const kvs::Real32 d = m_coord_table[1] - m_coord_table[0];
+    return d * d * d;
+}
+
 } // end of namespace YYZVis
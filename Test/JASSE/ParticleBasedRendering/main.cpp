@@ -23,6 +23,71 @@
 #include <kvs/StochasticRenderingCompositor>
 #include <kvs/StochasticLineRenderer>
 #include <kvs/ParticleBasedRenderer>
+#include <kvs/Scene>
+
+
+namespace
+{
+
+/*===========================================================================*/
+/**
+ *  @brief  Transfer function editor regenerating the particles.
+ *
+ *  The yin and yang particles are resampled only in the cells whose densities
+ *  or colors are changed by the edit.
+ */
+/*===========================================================================*/
+class TransferFunctionEditor : public kvs::glut::TransferFunctionEditor
+{
+private:
+    kvs::glut::Screen* m_particle_screen; ///< screen rendering the particles
+    YYZVis::YinYangGridSampling* m_yin_sampler; ///< particle generator for yin
+    YYZVis::YinYangGridSampling* m_yang_sampler; ///< particle generator for yang
+    const YYZVis::ZhongVolumeObject* m_zhong_volume; ///< zhong volume
+    size_t m_level; ///< subpixel level
+    float m_step; ///< sampling step
+
+public:
+    TransferFunctionEditor(
+        kvs::glut::Screen* screen,
+        YYZVis::YinYangGridSampling* yin_sampler,
+        YYZVis::YinYangGridSampling* yang_sampler,
+        const YYZVis::ZhongVolumeObject* zhong_volume,
+        const size_t level,
+        const float step ):
+        kvs::glut::TransferFunctionEditor( screen ),
+        m_particle_screen( screen ),
+        m_yin_sampler( yin_sampler ),
+        m_yang_sampler( yang_sampler ),
+        m_zhong_volume( zhong_volume ),
+        m_level( level ),
+        m_step( step )
+    {
+    }
+
+    void apply( kvs::TransferFunction tfunc )
+    {
+        kvs::Scene* scene = m_particle_screen->scene();
+
+        m_yin_sampler->resample( tfunc );
+        kvs::PointObject* yin_pnt = m_yin_sampler->newEnsemble( 0 );
+        yin_pnt->setName( "YinParticles" );
+        scene->replaceObject( "YinParticles", yin_pnt );
+
+        m_yang_sampler->resample( tfunc );
+        kvs::PointObject* yang_pnt = m_yang_sampler->newEnsemble( 0 );
+        yang_pnt->setName( "YangParticles" );
+        scene->replaceObject( "YangParticles", yang_pnt );
+
+        kvs::PointObject* zhong_pnt = new YYZVis::ZhongGridSampling( m_zhong_volume, m_level, m_step, tfunc );
+        zhong_pnt->setName( "ZhongParticles" );
+        scene->replaceObject( "ZhongParticles", zhong_pnt );
+
+        m_particle_screen->redraw();
+    }
+};
+
+} // end of namespace
 
 
 int main( int argc, char** argv )
@@ -139,9 +204,14 @@ int main( int argc, char** argv )
     const size_t subpixels = 1; // fixed to '1'
     const size_t level = static_cast<size_t>( subpixels * std::sqrt( double( repeats ) ) );
     const float step = 0.1f;
-    kvs::PointObject* yin_pnt = new YYZVis::YinYangGridSampling( &yin_volume, level, step, tfunc );
-    kvs::PointObject* yang_pnt = new YYZVis::YinYangGridSampling( &yang_volume, level, step, tfunc );
+    YYZVis::YinYangGridSampling yin_sampler( &yin_volume, level, step, tfunc );
+    YYZVis::YinYangGridSampling yang_sampler( &yang_volume, level, step, tfunc );
+    kvs::PointObject* yin_pnt = yin_sampler.newEnsemble( 0 );
+    kvs::PointObject* yang_pnt = yang_sampler.newEnsemble( 0 );
     kvs::PointObject* zhong_pnt = new YYZVis::ZhongGridSampling( &zhong_volume, level, step, tfunc );
+    yin_pnt->setName( "YinParticles" );
+    yang_pnt->setName( "YangParticles" );
+    zhong_pnt->setName( "ZhongParticles" );
 
 //    yin_pnt->setNormals( kvs::ValueArray<float>() );
 //    yang_pnt->setNormals( kvs::ValueArray<float>() );
@@ -219,7 +289,7 @@ int main( int argc, char** argv )
 
 //    kvs::Light::SetModelTwoSide( true );
 
-    kvs::glut::TransferFunctionEditor editor( &screen );
+    ::TransferFunctionEditor editor( &screen, &yin_sampler, &yang_sampler, &zhong_volume, level, step );
     editor.setVolumeObject( &yin_volume );
     editor.setTransferFunction( tfunc );
     editor.show();